@@ -0,0 +1,466 @@
+#include "alloctracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <new>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // PHASE RECORD STRUCT
+  struct PhaseRecord
+  {
+    const char *name;
+    AllocationStats frame;
+    AllocationStats total;
+    std::uint64_t worstFrameAllocations;
+  };
+
+  // everything here is constant initialized so that operator new can be called before main
+
+  std::atomic<std::uint64_t> totalAllocations(0);
+  std::atomic<std::uint64_t> totalDeallocations(0);
+  std::atomic<std::uint64_t> totalBytes(0);
+
+  thread_local bool isFrameThread = false;
+  bool inFrame = false;
+  AllocationStats frameStats = {0, 0, 0};
+  std::uint64_t framesCounted = 0;
+  std::uint64_t worstFrameAllocations = 0;
+
+  // phase 0 collects allocations made by the frame thread outside of any phase
+  PhaseRecord phases[AllocationTracker::MAX_PHASES] = {{"(no phase)", {0, 0, 0}, {0, 0, 0}, 0}};
+  std::size_t phaseCount = 1;
+  std::size_t phaseStack[AllocationTracker::MAX_PHASE_DEPTH] = {};
+  std::size_t phaseDepth = 0;
+  std::size_t phaseOverflow = 0;
+
+  bool steadyState = false;
+  std::uint64_t steadyStateViolations = 0;
+
+  std::atomic<std::uint32_t> sampleInterval(0);
+  std::atomic<std::uint64_t> sampleCounter(0);
+  std::atomic<std::uint64_t> samplesWritten(0);
+
+  // SAMPLE SLOT STRUCT
+  struct SampleSlot
+  {
+    // held while the sample is written or copied, so a sample is never read half written
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
+    AllocationSample sample;
+  };
+
+  SampleSlot samples[AllocationTracker::MAX_SAMPLES];
+
+  PhaseRecord &currentPhase()
+  {
+    return phases[phaseDepth > 0 ? phaseStack[phaseDepth - 1] : 0];
+  }
+
+  // frames above the caller of operator new belong to the tracker itself
+  constexpr int TRACKER_FRAMES = 6;
+
+  // the first backtrace() loads the unwinder, which allocates; do that before main instead
+  // of inside operator new
+  const bool backtracePrimed = []()
+  {
+    void *frame[1];
+    return backtrace(frame, 1) >= 0;
+  }();
+
+  void recordSample(const void *callSite, std::size_t size, const char *phase)
+  {
+    AllocationSample sample = {};
+    sample.bytes = size;
+    sample.phase = phase;
+
+    // the stack starts inside the tracker, skip ahead to the return address of operator new.
+    // depending on inlining that is a different number of frames, so search for it
+    void *stack[AllocationSample::MAX_FRAMES + TRACKER_FRAMES];
+    int depth = backtracePrimed ? backtrace(stack, static_cast<int>(AllocationSample::MAX_FRAMES + TRACKER_FRAMES)) : 0;
+    int first = 0;
+    while (first < depth && stack[first] != callSite)
+    {
+      ++first;
+    }
+    if (first == depth)
+    {
+      // not found, keep the return address of operator new on its own
+      sample.callStack[0] = callSite;
+      sample.frames = 1;
+    }
+    else
+    {
+      for (int i = first; i < depth && sample.frames < AllocationSample::MAX_FRAMES; ++i)
+      {
+        sample.callStack[sample.frames++] = stack[i];
+      }
+    }
+
+    // every thread claims its own slot, but a writer which has lapped the ring can still meet
+    // another writer or a reader in the same slot; the sample is dropped rather than waiting
+    // inside operator new
+    SampleSlot &slot = samples[samplesWritten.fetch_add(1, std::memory_order_relaxed) % AllocationTracker::MAX_SAMPLES];
+    if (slot.busy.test_and_set(std::memory_order_acquire))
+    {
+      return;
+    }
+    slot.sample = sample;
+    slot.busy.clear(std::memory_order_release);
+  }
+
+#if defined(GAMELIB_TRACK_ALLOCATIONS)
+  void recordAllocation(std::size_t size, const void *callSite)
+  {
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    totalBytes.fetch_add(size, std::memory_order_relaxed);
+
+    std::uint32_t interval = sampleInterval.load(std::memory_order_relaxed);
+    bool sample = interval != 0 && sampleCounter.fetch_add(1, std::memory_order_relaxed) % interval == 0;
+
+    if (!isFrameThread)
+    {
+      if (sample)
+      {
+        recordSample(callSite, size, "(other thread)");
+      }
+      return;
+    }
+
+    PhaseRecord &phase = currentPhase();
+    ++phase.frame.allocations;
+    phase.frame.bytes += size;
+    ++phase.total.allocations;
+    phase.total.bytes += size;
+
+    if (inFrame)
+    {
+      ++frameStats.allocations;
+      frameStats.bytes += size;
+
+      if (steadyState)
+      {
+        // always keep the call site of an allocation which should not have happened
+        ++steadyStateViolations;
+        sample = true;
+      }
+    }
+
+    if (sample)
+    {
+      recordSample(callSite, size, phase.name);
+    }
+  }
+
+  void recordDeallocation()
+  {
+    totalDeallocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (!isFrameThread)
+    {
+      return;
+    }
+
+    PhaseRecord &phase = currentPhase();
+    ++phase.frame.deallocations;
+    ++phase.total.deallocations;
+
+    if (inFrame)
+    {
+      ++frameStats.deallocations;
+    }
+  }
+
+  void *trackedAllocate(std::size_t size, const void *callSite)
+  {
+    recordAllocation(size, callSite);
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (!memory)
+    {
+      throw std::bad_alloc();
+    }
+    return memory;
+  }
+
+  void *trackedAllocateAligned(std::size_t size, std::size_t alignment, const void *callSite)
+  {
+    recordAllocation(size, callSite);
+    void *memory = nullptr;
+    if (posix_memalign(&memory, alignment < sizeof(void *) ? sizeof(void *) : alignment, size == 0 ? 1 : size) != 0)
+    {
+      throw std::bad_alloc();
+    }
+    return memory;
+  }
+
+  void trackedFree(void *memory)
+  {
+    if (memory)
+    {
+      recordDeallocation();
+      std::free(memory);
+    }
+  }
+#endif
+}
+
+#if defined(GAMELIB_TRACK_ALLOCATIONS)
+
+// replacement global allocation functions - every form of new and delete funnels into the tracker
+
+void *operator new(std::size_t size)
+{
+  return trackedAllocate(size, __builtin_return_address(0));
+}
+
+void *operator new[](std::size_t size)
+{
+  return trackedAllocate(size, __builtin_return_address(0));
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  try
+  {
+    return trackedAllocate(size, __builtin_return_address(0));
+  }
+  catch (const std::bad_alloc &)
+  {
+    return nullptr;
+  }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+  try
+  {
+    return trackedAllocate(size, __builtin_return_address(0));
+  }
+  catch (const std::bad_alloc &)
+  {
+    return nullptr;
+  }
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+  return trackedAllocateAligned(size, static_cast<std::size_t>(alignment), __builtin_return_address(0));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+  return trackedAllocateAligned(size, static_cast<std::size_t>(alignment), __builtin_return_address(0));
+}
+
+void operator delete(void *memory) noexcept { trackedFree(memory); }
+void operator delete[](void *memory) noexcept { trackedFree(memory); }
+void operator delete(void *memory, std::size_t) noexcept { trackedFree(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { trackedFree(memory); }
+void operator delete(void *memory, const std::nothrow_t &) noexcept { trackedFree(memory); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { trackedFree(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { trackedFree(memory); }
+void operator delete[](void *memory, std::align_val_t) noexcept { trackedFree(memory); }
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept { trackedFree(memory); }
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept { trackedFree(memory); }
+
+#endif
+
+// true when the allocation hooks are compiled in
+bool AllocationTracker::isEnabled()
+{
+#if defined(GAMELIB_TRACK_ALLOCATIONS)
+  return true;
+#else
+  return false;
+#endif
+}
+
+// counts since the program started, for all threads
+AllocationStats AllocationTracker::getTotals()
+{
+  return {totalAllocations.load(), totalDeallocations.load(), totalBytes.load()};
+}
+
+#if defined(GAMELIB_TRACK_ALLOCATIONS)
+
+// starts counting a frame on the calling thread
+void AllocationTracker::beginFrame()
+{
+  isFrameThread = true;
+  inFrame = true;
+  frameStats = {0, 0, 0};
+}
+
+// stops counting the frame and returns what it allocated
+AllocationStats AllocationTracker::endFrame()
+{
+  inFrame = false;
+  ++framesCounted;
+  if (frameStats.allocations > worstFrameAllocations)
+  {
+    worstFrameAllocations = frameStats.allocations;
+  }
+
+  for (std::size_t i = 0; i < phaseCount; ++i)
+  {
+    if (phases[i].frame.allocations > phases[i].worstFrameAllocations)
+    {
+      phases[i].worstFrameAllocations = phases[i].frame.allocations;
+    }
+    phases[i].frame = {0, 0, 0};
+  }
+
+  return frameStats;
+}
+
+// charges allocations to the named phase until the matching endPhase().
+void AllocationTracker::beginPhase(const char *name)
+{
+  if (phaseDepth == MAX_PHASE_DEPTH)
+  {
+    // too deep, keep charging the current phase but stay balanced with endPhase()
+    ++phaseOverflow;
+    return;
+  }
+
+  std::size_t index = 0;
+  for (std::size_t i = 1; i < phaseCount; ++i)
+  {
+    if (phases[i].name == name || std::strcmp(phases[i].name, name) == 0)
+    {
+      index = i;
+      break;
+    }
+  }
+  if (index == 0 && phaseCount < MAX_PHASES)
+  {
+    index = phaseCount++;
+    phases[index] = {name, {0, 0, 0}, {0, 0, 0}, 0};
+  }
+
+  phaseStack[phaseDepth++] = index;
+}
+
+// returns to the enclosing phase
+void AllocationTracker::endPhase()
+{
+  if (phaseOverflow > 0)
+  {
+    --phaseOverflow;
+  }
+  else if (phaseDepth > 0)
+  {
+    --phaseDepth;
+  }
+}
+
+#endif
+
+// record a call site sample for every nth allocation, zero turns sampling off
+void AllocationTracker::setSampleInterval(std::uint32_t everyNth)
+{
+  sampleInterval.store(everyNth);
+}
+
+// while in steady state every allocation made in a frame is a violation
+void AllocationTracker::setSteadyState(bool steady)
+{
+  steadyState = steady;
+}
+
+// number of allocations made in a frame while in steady state
+std::uint64_t AllocationTracker::getSteadyStateViolations()
+{
+  return steadyStateViolations;
+}
+
+// number of samples currently held
+std::size_t AllocationTracker::getSampleCount()
+{
+  std::uint64_t written = samplesWritten.load();
+  return written < MAX_SAMPLES ? static_cast<std::size_t>(written) : MAX_SAMPLES;
+}
+
+// a sample recorded by operator new, index 0 is the oldest
+AllocationSample AllocationTracker::getSample(std::size_t index)
+{
+  std::uint64_t written = samplesWritten.load();
+  std::uint64_t oldest = written < MAX_SAMPLES ? 0 : written % MAX_SAMPLES;
+  SampleSlot &slot = samples[(oldest + index) % MAX_SAMPLES];
+  while (slot.busy.test_and_set(std::memory_order_acquire))
+  {
+    // a writer only holds the slot for as long as it takes to copy one sample
+  }
+  AllocationSample sample = slot.sample;
+  slot.busy.clear(std::memory_order_release);
+  return sample;
+}
+
+// prints the totals, per phase counts and samples
+void AllocationTracker::report(std::ostream &out)
+{
+  if (!isEnabled())
+  {
+    out << "allocation tracking is not compiled in (define GAMELIB_TRACK_ALLOCATIONS)" << std::endl;
+    return;
+  }
+
+  AllocationStats totals = getTotals();
+  out << "allocations: " << totals.allocations
+      << " deallocations: " << totals.deallocations
+      << " bytes: " << totals.bytes << std::endl;
+  out << "frames: " << framesCounted
+      << " worst frame: " << worstFrameAllocations << " allocations" << std::endl;
+  out << "steady state violations: " << steadyStateViolations << std::endl;
+
+  out << std::left << std::setw(20) << "phase"
+      << std::right << std::setw(14) << "allocations"
+      << std::setw(14) << "bytes"
+      << std::setw(14) << "worst frame" << std::endl;
+  for (std::size_t i = 0; i < phaseCount; ++i)
+  {
+    out << std::left << std::setw(20) << phases[i].name
+        << std::right << std::setw(14) << phases[i].total.allocations
+        << std::setw(14) << phases[i].total.bytes
+        << std::setw(14) << phases[i].worstFrameAllocations << std::endl;
+  }
+
+  std::size_t sampleCount = getSampleCount();
+  if (sampleCount > 0)
+  {
+    out << "call stack samples (resolve with addr2line -f -C -e module offset, or atos):" << std::endl;
+    for (std::size_t i = 0; i < sampleCount; ++i)
+    {
+      AllocationSample sample = getSample(i);
+      out << "  " << sample.bytes << " bytes in " << sample.phase << std::endl;
+      for (std::size_t frame = 0; frame < sample.frames; ++frame)
+      {
+        // return addresses point just past the call, step back one byte to land on the call itself
+        const char *address = static_cast<const char *>(sample.callStack[frame]) - 1;
+        Dl_info info;
+        if (dladdr(address, &info) != 0 && info.dli_fname)
+        {
+          const char *module = std::strrchr(info.dli_fname, '/');
+          out << "    " << (module ? module + 1 : info.dli_fname)
+              << "+0x" << std::hex << static_cast<std::uintptr_t>(address - static_cast<const char *>(info.dli_fbase)) << std::dec;
+          if (info.dli_sname)
+          {
+            out << " (" << info.dli_sname << ")";
+          }
+          out << std::endl;
+        }
+        else
+        {
+          out << "    " << static_cast<const void *>(address) << std::endl;
+        }
+      }
+    }
+  }
+}
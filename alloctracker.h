@@ -0,0 +1,132 @@
+#ifndef ALLOCTRACKER_H
+#define ALLOCTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+namespace gamelib
+{
+
+  /*
+
+  AllocationTracker
+    - counts heap allocations by replacing the global operator new and operator delete
+    - the hooks are only compiled in when GAMELIB_TRACK_ALLOCATIONS is defined
+      (make TRACK_ALLOCATIONS=1 for the game, the benchmark always has them);
+      without it the frame and phase calls are empty inline functions and every count
+      stays at zero
+    - allocations from every thread are counted in the totals, but only allocations made by
+      the thread which calls beginFrame() are counted per frame and per phase
+    - a phase is a named section of the frame, such as "update" or "render"; phases can nest
+      and allocations are charged to the innermost one
+    - every Nth allocation records a sample of its call stack (up to
+      AllocationSample::MAX_FRAMES return addresses taken with backtrace(), starting at the
+      code which called operator new), so that an allocation made inside the standard
+      library can still be traced back to the game code which caused it; the report prints
+      each address as module+offset, which addr2line -f -C -e module offset or atos resolves
+    - in steady state every allocation made by the frame thread is a violation and is sampled,
+      which is how the benchmark checks that the hot path does not allocate
+
+  */
+
+  // ALLOCATION STATS STRUCT
+  struct AllocationStats
+  {
+    std::uint64_t allocations;
+    std::uint64_t deallocations;
+    std::uint64_t bytes;
+  };
+
+  // ALLOCATION SAMPLE STRUCT
+  struct AllocationSample
+  {
+    // most return addresses kept per sample
+    static constexpr std::size_t MAX_FRAMES = 8;
+
+    // return addresses, innermost first: callStack[0] is in the code which called operator new
+    const void *callStack[MAX_FRAMES];
+    std::size_t frames;
+    std::size_t bytes;
+    const char *phase;
+  };
+
+  // ALLOCATION TRACKER CLASS
+  class AllocationTracker
+  {
+  public:
+    // most distinct phase names which can be tracked
+    static constexpr std::size_t MAX_PHASES = 16;
+
+    // deepest phase nesting
+    static constexpr std::size_t MAX_PHASE_DEPTH = 8;
+
+    // number of call site samples kept, older samples are overwritten
+    static constexpr std::size_t MAX_SAMPLES = 64;
+
+    // true when the allocation hooks are compiled in
+    static bool isEnabled();
+
+    // counts since the program started, for all threads
+    static AllocationStats getTotals();
+
+#if defined(GAMELIB_TRACK_ALLOCATIONS)
+    // starts counting a frame on the calling thread
+    static void beginFrame();
+
+    // stops counting the frame and returns what it allocated
+    static AllocationStats endFrame();
+
+    // charges allocations to the named phase until the matching endPhase().
+    // the name must stay valid for the life of the program (use a string literal)
+    static void beginPhase(const char *name);
+
+    // returns to the enclosing phase
+    static void endPhase();
+#else
+    // without the hooks there is nothing to count, so these compile away
+    static void beginFrame() {}
+    static AllocationStats endFrame() { return {0, 0, 0}; }
+    static void beginPhase(const char *) {}
+    static void endPhase() {}
+#endif
+
+    // record a call site sample for every nth allocation, zero turns sampling off
+    static void setSampleInterval(std::uint32_t everyNth);
+
+    // while in steady state every allocation made in a frame is a violation
+    static void setSteadyState(bool steady);
+
+    // number of allocations made in a frame while in steady state
+    static std::uint64_t getSteadyStateViolations();
+
+    // number of samples currently held
+    static std::size_t getSampleCount();
+
+    // a sample recorded by operator new, index 0 is the oldest
+    static AllocationSample getSample(std::size_t index);
+
+    // prints the totals, per phase counts and samples
+    static void report(std::ostream &out);
+  };
+
+  /*
+
+  AllocationPhase
+    - begins a phase when constructed and ends it when destroyed
+
+  */
+
+  // ALLOCATION PHASE CLASS
+  class AllocationPhase
+  {
+  public:
+    explicit AllocationPhase(const char *name) { AllocationTracker::beginPhase(name); }
+    ~AllocationPhase() { AllocationTracker::endPhase(); }
+
+    AllocationPhase(const AllocationPhase &other) = delete;
+    AllocationPhase &operator=(const AllocationPhase &other) = delete;
+  };
+}
+
+#endif
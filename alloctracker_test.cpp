@@ -0,0 +1,128 @@
+#include "alloctracker.h"
+#include "testing.h"
+
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // calls operator new directly, which the compiler may not optimize away like a new expression
+  __attribute__((noinline)) void *allocateFromKnownFunction(std::size_t bytes)
+  {
+    return ::operator new(bytes);
+  }
+
+  // a frame counts what the frame thread allocated in it
+  void testFrameCountsAllocations()
+  {
+    AllocationTracker::beginFrame();
+    void *first = ::operator new(100);
+    void *second = ::operator new(28);
+    ::operator delete(first);
+    AllocationStats stats = AllocationTracker::endFrame();
+    ::operator delete(second);
+
+    CHECK(stats.allocations == 2);
+    CHECK(stats.deallocations == 1);
+    CHECK(stats.bytes == 128);
+
+    AllocationTracker::beginFrame();
+    stats = AllocationTracker::endFrame();
+    CHECK(stats.allocations == 0);
+  }
+
+  // allocations made by other threads count in the totals but not in the frame
+  void testOtherThreadsAreNotCountedInTheFrame()
+  {
+    AllocationStats before = AllocationTracker::getTotals();
+    AllocationTracker::beginFrame();
+    std::thread worker([]() { ::operator delete(::operator new(64)); });
+    worker.join();
+    AllocationStats stats = AllocationTracker::endFrame();
+    AllocationStats after = AllocationTracker::getTotals();
+
+    // starting the thread may allocate on this thread, the worker's 64 bytes must not show up
+    CHECK(after.allocations - before.allocations > stats.allocations);
+    CHECK(after.bytes - before.bytes >= stats.bytes + 64);
+  }
+
+  // in steady state every allocation in a frame is a violation, allocations outside of frames are not
+  void testSteadyStateCountsViolations()
+  {
+    std::uint64_t before = AllocationTracker::getSteadyStateViolations();
+    AllocationTracker::setSteadyState(true);
+
+    AllocationTracker::beginFrame();
+    AllocationTracker::endFrame();
+    CHECK(AllocationTracker::getSteadyStateViolations() == before);
+
+    AllocationTracker::beginFrame();
+    void *memory = ::operator new(16);
+    AllocationTracker::endFrame();
+    void *outside = ::operator new(16);
+
+    AllocationTracker::setSteadyState(false);
+    ::operator delete(memory);
+    ::operator delete(outside);
+    CHECK(AllocationTracker::getSteadyStateViolations() == before + 1);
+  }
+
+  // a violation is always sampled, with a stack starting in the code which called operator new
+  void testViolationSampleHoldsTheCallStack()
+  {
+    AllocationTracker::setSteadyState(true);
+    AllocationTracker::beginFrame();
+    void *memory;
+    {
+      AllocationPhase phase("sampled");
+      memory = allocateFromKnownFunction(24);
+    }
+    AllocationTracker::endFrame();
+    AllocationTracker::setSteadyState(false);
+    ::operator delete(memory);
+
+    CHECK(AllocationTracker::getSampleCount() > 0);
+    AllocationSample sample = AllocationTracker::getSample(AllocationTracker::getSampleCount() - 1);
+    CHECK(sample.bytes == 24);
+    CHECK(std::string(sample.phase) == "sampled");
+    CHECK(sample.frames > 1 && sample.frames <= AllocationSample::MAX_FRAMES);
+
+    // the first return address is inside allocateFromKnownFunction, a few bytes past its start
+    const char *function = reinterpret_cast<const char *>(&allocateFromKnownFunction);
+    const char *returnAddress = static_cast<const char *>(sample.callStack[0]);
+    CHECK(returnAddress > function && returnAddress < function + 256);
+  }
+
+  // phases nest and show up in the report
+  void testPhasesAppearInTheReport()
+  {
+    AllocationTracker::beginFrame();
+    {
+      AllocationPhase outer("outer phase");
+      AllocationPhase inner("inner phase");
+      ::operator delete(::operator new(8));
+    }
+    AllocationTracker::endFrame();
+
+    std::ostringstream report;
+    AllocationTracker::report(report);
+    CHECK(report.str().find("outer phase") != std::string::npos);
+    CHECK(report.str().find("inner phase") != std::string::npos);
+  }
+}
+
+int main()
+{
+  CHECK(AllocationTracker::isEnabled());
+  testFrameCountsAllocations();
+  testOtherThreadsAreNotCountedInTheFrame();
+  testSteadyStateCountsViolations();
+  testViolationSampleHoldsTheCallStack();
+  testPhasesAppearInTheReport();
+  return finishTests("alloctracker");
+}
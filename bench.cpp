@@ -0,0 +1,331 @@
+#include "window.h"
+#include "bullets.h"
+#include "particles.h"
+#include "alloctracker.h"
+#include "ecs.h"
+#include "components.h"
+#include "collision.h"
+#include "framepacer.h"
+#include "snapshot.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+/*
+
+  headless benchmark
+    - runs the simulation side of the game at a fixed time step without opening a window
+    - usage: ./benchbin [frames] [--load snapshot] [--save snapshot] [--capture prefix [--png]]
+    - --load starts from a snapshot saved by an earlier run instead of the fresh wave,
+      --save writes the state at the end of the run (particles are not part of a snapshot)
+    - --capture draws every frame into a hidden window and writes it to prefix_NNNNNN.ppm
+      (or .png) from a background thread; drawing and reading back happen outside of the
+      timed and counted frame, so the reported frame times and allocations match a run without
+      capture and the capture cost is reported on its own. set SDL_VIDEODRIVER=dummy to
+      capture without a display
+    - after WARMUP_FRAMES the loop is expected to be in steady state and must not allocate;
+      when allocation tracking is compiled in, any allocation fails the benchmark
+    - frames run uncapped and the frame time jitter of the steady state frames is reported
+
+*/
+
+constexpr int WIDTH = 800;
+constexpr int HEIGHT = 600;
+
+constexpr int DEFAULT_FRAMES = 600;
+constexpr float DELTA_TIME = 1.0f / 60.0f;
+constexpr int WARMUP_FRAMES = 120;
+
+constexpr int NUM_ENEMIES = 2000;
+constexpr double ENEMY_SPEED = 180;
+constexpr double ENEMY_SIZE = 50;
+constexpr double BULLET_SIZE = 8;
+
+constexpr int MAX_BULLETS = 50000;
+constexpr int NUM_TURRETS = 16;
+constexpr double TURRET_BULLET_SPEED = 150;
+
+constexpr int MAX_PARTICLES = 100000;
+constexpr int EXPLOSIONS_PER_FRAME = 4;
+
+int main(int argc, char *argv[])
+{
+  int frames = DEFAULT_FRAMES;
+  std::string loadPath;
+  std::string savePath;
+  std::string capturePath;
+  gamelib::CaptureFormat captureFormat = gamelib::CaptureFormat::Raw;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--load" && i + 1 < argc)
+    {
+      loadPath = argv[++i];
+    }
+    else if (arg == "--save" && i + 1 < argc)
+    {
+      savePath = argv[++i];
+    }
+    else if (arg == "--capture" && i + 1 < argc)
+    {
+      capturePath = argv[++i];
+    }
+    else if (arg == "--png")
+    {
+      captureFormat = gamelib::CaptureFormat::Png;
+    }
+    else
+    {
+      frames = std::atoi(argv[i]);
+    }
+  }
+
+  std::cout << "creating enemy entities" << std::endl;
+  gamelib::World world;
+  for (int i = 0; i < NUM_ENEMIES; i++)
+  {
+    double x = (i * 37) % WIDTH;
+    double y = (i * 91) % HEIGHT;
+    double direction = i % 2 == 0 ? 1.0 : -1.0;
+    world.create(
+        gamelib::Position{gamelib::toState(x), gamelib::toState(y)},
+        gamelib::Velocity{gamelib::toState(ENEMY_SPEED * direction), gamelib::toState(ENEMY_SPEED * 0.5)},
+        gamelib::Enemy{});
+  }
+
+  gamelib::AabbArray enemyBoxes(NUM_ENEMIES);
+  // sized to the padded box count every frame
+  std::vector<std::uint32_t> enemyHits;
+  std::uint64_t totalHits = 0;
+
+  std::cout << "creating bullet pool and turrets" << std::endl;
+  gamelib::BulletPool bullets(MAX_BULLETS);
+  gamelib::BulletPattern turretPattern = gamelib::BulletPattern::ring(24, TURRET_BULLET_SPEED);
+  std::vector<gamelib::BulletEmitter> turrets;
+  for (int i = 0; i < NUM_TURRETS; i++)
+  {
+    gamelib::BulletEmitter turret(&turretPattern, 0.05);
+    turret.setSpin(0.1 + 0.01 * i);
+    turrets.push_back(turret);
+  }
+
+  std::cout << "creating particle system" << std::endl;
+  gamelib::ParticleSystem particles(MAX_PARTICLES);
+  particles.setDrag(1.0f);
+  int explosionEmitter = particles.createEmitter({500, 40.0f, 260.0f, 1.0f, 2.0f, 4.0f, 255, 160, 32}, MAX_PARTICLES);
+
+  gamelib::Snapshot snapshot;
+  if (!loadPath.empty())
+  {
+    std::cout << "loading snapshot " << loadPath << std::endl;
+    snapshot.loadFromFile(loadPath);
+    snapshot.restore(world);
+    snapshot.restore(bullets);
+    for (auto &turret : turrets)
+    {
+      snapshot.restore(turret);
+    }
+  }
+
+  std::unique_ptr<gamelib::Window> captureWindow;
+  std::vector<SDL_FRect> captureRects;
+  if (!capturePath.empty())
+  {
+    std::cout << "capturing frames to " << capturePath << std::endl;
+    captureWindow.reset(new gamelib::Window("bench", WIDTH, HEIGHT, true));
+    captureWindow->startCapture(capturePath, captureFormat);
+    captureRects.reserve(MAX_BULLETS);
+  }
+
+  std::cout << "running " << frames << " frames" << std::endl;
+
+  gamelib::FramePacer pacer;
+  pacer.setMode(gamelib::FrameMode::Uncapped);
+
+  // only the simulation is timed, capturing is timed on its own
+  std::chrono::steady_clock::duration simulationTime(0);
+  std::chrono::steady_clock::duration captureTime(0);
+
+  for (int frame = 0; frame < frames; frame++)
+  {
+    if (frame == WARMUP_FRAMES)
+    {
+      gamelib::AllocationTracker::setSteadyState(true);
+      pacer.reset();
+    }
+
+    auto frameStart = std::chrono::steady_clock::now();
+    pacer.beginFrame();
+
+    gamelib::AllocationTracker::beginFrame();
+
+    gamelib::AllocationTracker::beginPhase("enemies");
+    gamelib::StateScalar step = gamelib::toState(DELTA_TIME);
+    gamelib::StateScalar left = gamelib::toState(0);
+    gamelib::StateScalar top = gamelib::toState(0);
+    gamelib::StateScalar right = gamelib::toState(WIDTH);
+    gamelib::StateScalar bottom = gamelib::toState(HEIGHT);
+    world.each<gamelib::Position, gamelib::Velocity, gamelib::Enemy>(
+        [&](gamelib::EntityHandle, gamelib::Position &position, gamelib::Velocity &velocity, gamelib::Enemy &)
+        {
+          position.x += velocity.x * step;
+          position.y += velocity.y * step;
+          if (position.x < left || position.x > right)
+          {
+            velocity.x = -velocity.x;
+          }
+          if (position.y < top || position.y > bottom)
+          {
+            velocity.y = -velocity.y;
+          }
+        });
+    gamelib::AllocationTracker::endPhase();
+
+    gamelib::AllocationTracker::beginPhase("bullets");
+    for (int i = 0; i < NUM_TURRETS; i++)
+    {
+      double x = WIDTH * (i + 0.5) / NUM_TURRETS;
+      turrets[i].update(bullets, x, HEIGHT * 0.5, DELTA_TIME);
+    }
+    bullets.applyVelocity(DELTA_TIME);
+    bullets.removeOutside(0, 0, WIDTH, HEIGHT);
+    gamelib::AllocationTracker::endPhase();
+
+    gamelib::AllocationTracker::beginPhase("collision");
+    enemyBoxes.clear();
+    world.each<gamelib::Position, gamelib::Enemy>(
+        [&](gamelib::EntityHandle, gamelib::Position &position, gamelib::Enemy &)
+        {
+          enemyBoxes.add({
+              static_cast<float>(gamelib::fromState(position.x) - ENEMY_SIZE * 0.5),
+              static_cast<float>(gamelib::fromState(position.y) - ENEMY_SIZE * 0.5),
+              static_cast<float>(gamelib::fromState(position.x) + ENEMY_SIZE * 0.5),
+              static_cast<float>(gamelib::fromState(position.y) + ENEMY_SIZE * 0.5)});
+        });
+    enemyHits.resize(enemyBoxes.paddedSize());
+    for (std::size_t i = 0; i < bullets.size(); i++)
+    {
+      double x = bullets.getPositionX(i);
+      double y = bullets.getPositionY(i);
+      gamelib::Aabb bulletBox = {
+          static_cast<float>(x - BULLET_SIZE * 0.5),
+          static_cast<float>(y - BULLET_SIZE * 0.5),
+          static_cast<float>(x + BULLET_SIZE * 0.5),
+          static_cast<float>(y + BULLET_SIZE * 0.5)};
+      totalHits += gamelib::overlapOneToMany(bulletBox, enemyBoxes, enemyHits.data(), enemyHits.size());
+    }
+    gamelib::AllocationTracker::endPhase();
+
+    gamelib::AllocationTracker::beginPhase("particles");
+    for (int i = 0; i < EXPLOSIONS_PER_FRAME; i++)
+    {
+      float x = static_cast<float>((frame * 97 + i * 211) % WIDTH);
+      float y = static_cast<float>((frame * 53 + i * 137) % HEIGHT);
+      particles.emit(explosionEmitter, x, y);
+    }
+    particles.update(DELTA_TIME);
+    gamelib::AllocationTracker::endPhase();
+
+    gamelib::AllocationTracker::endFrame();
+
+    pacer.endFrame();
+    auto frameEnd = std::chrono::steady_clock::now();
+    simulationTime += frameEnd - frameStart;
+
+    if (captureWindow)
+    {
+      SDL_Renderer *renderer = captureWindow->getRenderer().get();
+      captureWindow->processEvents();
+      captureWindow->prepareRender();
+
+      captureRects.clear();
+      world.each<gamelib::Position, gamelib::Enemy>(
+          [&](gamelib::EntityHandle, gamelib::Position &position, gamelib::Enemy &)
+          {
+            captureRects.push_back({
+                static_cast<float>(gamelib::fromState(position.x) - ENEMY_SIZE * 0.5),
+                static_cast<float>(gamelib::fromState(position.y) - ENEMY_SIZE * 0.5),
+                static_cast<float>(ENEMY_SIZE),
+                static_cast<float>(ENEMY_SIZE)});
+          });
+      SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+      SDL_RenderFillRectsF(renderer, captureRects.data(), static_cast<int>(captureRects.size()));
+
+      captureRects.clear();
+      for (std::size_t i = 0; i < bullets.size(); ++i)
+      {
+        captureRects.push_back({
+            static_cast<float>(bullets.getPositionX(i) - BULLET_SIZE * 0.5),
+            static_cast<float>(bullets.getPositionY(i) - BULLET_SIZE * 0.5),
+            static_cast<float>(BULLET_SIZE),
+            static_cast<float>(BULLET_SIZE)});
+      }
+      SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
+      SDL_RenderFillRectsF(renderer, captureRects.data(), static_cast<int>(captureRects.size()));
+
+      particles.render(renderer);
+      captureWindow->presentRender();
+      captureTime += std::chrono::steady_clock::now() - frameEnd;
+    }
+  }
+
+  gamelib::AllocationTracker::setSteadyState(false);
+  double elapsedMs = std::chrono::duration<double, std::milli>(simulationTime).count();
+
+  std::cout << "frames: " << frames << std::endl;
+  std::cout << "total: " << elapsedMs << " ms" << std::endl;
+  std::cout << "per frame: " << (frames > 0 ? elapsedMs / frames : 0.0) << " ms" << std::endl;
+  std::cout << "live enemies: " << world.size() << std::endl;
+  std::cout << "live bullets: " << bullets.size() << std::endl;
+  std::cout << "bullet hits: " << totalHits << std::endl;
+  std::cout << "live particles: " << particles.size() << std::endl;
+
+  // time a save and restore of the final state, restoring it over itself changes nothing
+  auto saveStart = std::chrono::steady_clock::now();
+  snapshot.beginSave();
+  snapshot.save(world);
+  snapshot.save(bullets);
+  for (auto &turret : turrets)
+  {
+    snapshot.save(turret);
+  }
+  auto restoreStart = std::chrono::steady_clock::now();
+  snapshot.rewind();
+  snapshot.restore(world);
+  snapshot.restore(bullets);
+  for (auto &turret : turrets)
+  {
+    snapshot.restore(turret);
+  }
+  auto restoreEnd = std::chrono::steady_clock::now();
+  std::cout << "snapshot: " << snapshot.size() << " bytes"
+            << " save: " << std::chrono::duration<double, std::micro>(restoreStart - saveStart).count() << " us"
+            << " restore: " << std::chrono::duration<double, std::micro>(restoreEnd - restoreStart).count() << " us" << std::endl;
+  if (!savePath.empty())
+  {
+    snapshot.saveToFile(savePath);
+    std::cout << "saved snapshot " << savePath << std::endl;
+  }
+
+  pacer.report(std::cout);
+  if (captureWindow)
+  {
+    double captureMs = std::chrono::duration<double, std::milli>(captureTime).count();
+    std::cout << "capture (not included above): " << captureMs << " ms"
+              << " per frame: " << (frames > 0 ? captureMs / frames : 0.0) << " ms" << std::endl;
+    captureWindow->stopCapture();
+    captureWindow->getFrameCapture().report(std::cout);
+  }
+  gamelib::AllocationTracker::report(std::cout);
+
+  if (gamelib::AllocationTracker::getSteadyStateViolations() > 0)
+  {
+    std::cout << "FAILED: the steady state loop allocated" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,273 @@
+#include "bullets.h"
+
+#include <algorithm>
+#include <cmath>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+// creates an empty pool able to hold up to maxBullets bullets
+BulletPool::BulletPool(std::size_t maxBullets) : capacity(maxBullets),
+                                                 count(0),
+                                                 positionX(maxBullets),
+                                                 positionY(maxBullets),
+                                                 velocityX(maxBullets),
+                                                 velocityY(maxBullets) {}
+
+// removes every bullet
+void BulletPool::clear()
+{
+  count = 0;
+}
+
+// spawns up to n bullets at the given world position with the given velocities copied as-is.
+std::size_t BulletPool::spawn(double x, double y, const StateScalar *vx, const StateScalar *vy, std::size_t n)
+{
+  n = std::min(n, capacity - count);
+
+  // the velocity table is already in the layout of the pool, so spawning is a straight copy
+  std::fill_n(positionX.data() + count, n, toState(x));
+  std::fill_n(positionY.data() + count, n, toState(y));
+  std::copy_n(vx, n, velocityX.data() + count);
+  std::copy_n(vy, n, velocityY.data() + count);
+
+  count += n;
+  return n;
+}
+
+// spawns up to n bullets at the given world position with the given velocities
+// rotated by the unit vector (cosAngle, sinAngle).
+std::size_t BulletPool::spawnRotated(double x, double y, const StateScalar *vx, const StateScalar *vy, std::size_t n, double cosAngle, double sinAngle)
+{
+  n = std::min(n, capacity - count);
+
+  std::fill_n(positionX.data() + count, n, toState(x));
+  std::fill_n(positionY.data() + count, n, toState(y));
+
+  StateScalar c = toState(cosAngle);
+  StateScalar s = toState(sinAngle);
+  StateScalar *outX = velocityX.data() + count;
+  StateScalar *outY = velocityY.data() + count;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    outX[i] = vx[i] * c - vy[i] * s;
+    outY[i] = vx[i] * s + vy[i] * c;
+  }
+
+  count += n;
+  return n;
+}
+
+// simple linear integration of velocity for every bullet
+void BulletPool::applyVelocity(double deltaTime)
+{
+  StateScalar step = toState(deltaTime);
+  StateScalar *x = positionX.data();
+  StateScalar *y = positionY.data();
+  const StateScalar *vx = velocityX.data();
+  const StateScalar *vy = velocityY.data();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    x[i] += vx[i] * step;
+    y[i] += vy[i] * step;
+  }
+}
+
+// removes the bullet at index by moving the last bullet into its slot
+void BulletPool::kill(std::size_t index)
+{
+  if (index >= count)
+  {
+    return;
+  }
+  std::size_t last = --count;
+  positionX[index] = positionX[last];
+  positionY[index] = positionY[last];
+  velocityX[index] = velocityX[last];
+  velocityY[index] = velocityY[last];
+}
+
+// removes every bullet whose position is outside of the given rectangle
+void BulletPool::removeOutside(double minX, double minY, double maxX, double maxY)
+{
+  StateScalar left = toState(minX);
+  StateScalar top = toState(minY);
+  StateScalar right = toState(maxX);
+  StateScalar bottom = toState(maxY);
+  std::size_t i = 0;
+  while (i < count)
+  {
+    StateScalar x = positionX[i];
+    StateScalar y = positionY[i];
+    if (x < left || x > right || y < top || y > bottom)
+    {
+      // do not advance, the slot now holds a bullet which has not been checked yet
+      kill(i);
+    }
+    else
+    {
+      ++i;
+    }
+  }
+}
+
+BulletPattern::BulletPattern() : velocityX(),
+                                 velocityY() {}
+
+// one bullet straight ahead
+BulletPattern BulletPattern::single(double speed)
+{
+  BulletPattern pattern;
+  pattern.velocityX.push_back(toState(speed));
+  pattern.velocityY.push_back(toState(0.0));
+  return pattern;
+}
+
+// count bullets fanned evenly across arcRadians, centered straight ahead
+BulletPattern BulletPattern::spread(int count, double arcRadians, double speed)
+{
+  BulletPattern pattern;
+  if (count == 1)
+  {
+    return single(speed);
+  }
+  double step = arcRadians / (count - 1);
+  double start = -arcRadians * 0.5;
+  for (int i = 0; i < count; ++i)
+  {
+    double angle = start + step * i;
+    pattern.velocityX.push_back(toState(cos(angle) * speed));
+    pattern.velocityY.push_back(toState(sin(angle) * speed));
+  }
+  return pattern;
+}
+
+// count bullets spaced evenly around a full circle, the first one straight ahead
+BulletPattern BulletPattern::ring(int count, double speed)
+{
+  BulletPattern pattern;
+  double step = (2.0 * M_PI) / count;
+  for (int i = 0; i < count; ++i)
+  {
+    double angle = step * i;
+    pattern.velocityX.push_back(toState(cos(angle) * speed));
+    pattern.velocityY.push_back(toState(sin(angle) * speed));
+  }
+  return pattern;
+}
+
+// count bullets straight ahead with speeds stepped evenly from minSpeed to maxSpeed
+BulletPattern BulletPattern::burst(int count, double minSpeed, double maxSpeed)
+{
+  BulletPattern pattern;
+  if (count == 1)
+  {
+    return single(maxSpeed);
+  }
+  double step = (maxSpeed - minSpeed) / (count - 1);
+  for (int i = 0; i < count; ++i)
+  {
+    pattern.velocityX.push_back(toState(minSpeed + step * i));
+    pattern.velocityY.push_back(toState(0.0));
+  }
+  return pattern;
+}
+
+// creates an emitter facing along +X which fires the pattern every fireInterval seconds when updated
+BulletEmitter::BulletEmitter(const BulletPattern *withPattern, double withFireInterval) : pattern(withPattern),
+                                                                                         fireInterval(withFireInterval),
+                                                                                         fireTime(0),
+                                                                                         orientationX(1),
+                                                                                         orientationY(0),
+                                                                                         spinCos(1),
+                                                                                         spinSin(0),
+                                                                                         spinning(false) {}
+
+// rotate the orientation by radiansPerVolley after every volley (zero disables spinning)
+void BulletEmitter::setSpin(double radiansPerVolley)
+{
+  spinning = radiansPerVolley != 0.0;
+  spinCos = cos(radiansPerVolley);
+  spinSin = sin(radiansPerVolley);
+}
+
+// point the emitter at an angle
+void BulletEmitter::setOrientation(double radians)
+{
+  orientationX = cos(radians);
+  orientationY = sin(radians);
+}
+
+// point the emitter along a direction vector of any length, without trigonometry
+void BulletEmitter::setDirection(double directionX, double directionY)
+{
+  double magnitude = sqrt(directionX * directionX + directionY * directionY);
+  if (magnitude == 0.0)
+  {
+    return;
+  }
+  orientationX = directionX / magnitude;
+  orientationY = directionY / magnitude;
+}
+
+// emits one volley along the given unit vector
+std::size_t BulletEmitter::emit(BulletPool &pool, double x, double y, double directionX, double directionY)
+{
+  if (directionX == 1.0 && directionY == 0.0)
+  {
+    // the pattern table is already facing the right way
+    return pool.spawn(x, y, pattern->getVelocitiesX(), pattern->getVelocitiesY(), pattern->size());
+  }
+  return pool.spawnRotated(x, y, pattern->getVelocitiesX(), pattern->getVelocitiesY(), pattern->size(), directionX, directionY);
+}
+
+// fires one volley from the given world position toward the given target position.
+std::size_t BulletEmitter::fireAt(BulletPool &pool, double x, double y, double targetX, double targetY)
+{
+  double directionX = targetX - x;
+  double directionY = targetY - y;
+  double magnitude = sqrt(directionX * directionX + directionY * directionY);
+  if (magnitude == 0.0)
+  {
+    // the target is right on top of the emitter, fire straight ahead
+    return emit(pool, x, y, 1.0, 0.0);
+  }
+  return emit(pool, x, y, directionX / magnitude, directionY / magnitude);
+}
+
+// fires one volley from the given world position along the current orientation.
+std::size_t BulletEmitter::fire(BulletPool &pool, double x, double y)
+{
+  std::size_t spawned = emit(pool, x, y, orientationX, orientationY);
+
+  if (spinning)
+  {
+    // rotate the orientation by multiplying with the spin vector, then renormalize
+    // so that rounding errors do not accumulate over thousands of volleys
+    double rotatedX = orientationX * spinCos - orientationY * spinSin;
+    double rotatedY = orientationX * spinSin + orientationY * spinCos;
+    double magnitude = sqrt(rotatedX * rotatedX + rotatedY * rotatedY);
+    orientationX = rotatedX / magnitude;
+    orientationY = rotatedY / magnitude;
+  }
+
+  return spawned;
+}
+
+// advances the firing clock and fires as many volleys as are due along the current orientation.
+std::size_t BulletEmitter::update(BulletPool &pool, double x, double y, double deltaTime)
+{
+  std::size_t spawned = 0;
+  if (fireInterval <= 0.0)
+  {
+    // an emitter without an interval only fires when told to
+    return spawned;
+  }
+  fireTime += deltaTime;
+  while (fireTime >= fireInterval)
+  {
+    fireTime -= fireInterval;
+    spawned += fire(pool, x, y);
+  }
+  return spawned;
+}
@@ -0,0 +1,183 @@
+#ifndef BULLETS_H
+#define BULLETS_H
+
+#include <cstddef>
+#include <vector>
+
+#include "scalar.h"
+
+namespace gamelib
+{
+
+  /*
+
+  BulletPool
+    - every projectile lives in a BulletPool instead of being an Entity
+    - the pool has a fixed capacity which is allocated once when it is constructed
+    - bullet state is stored as parallel arrays (structure of arrays) of StateScalar so
+      that the update and collision loops walk contiguous memory
+    - bullets are spawned in batches by appending to the end of the arrays
+    - bullets are removed by moving the last live bullet into the freed slot,
+      so the order of bullets within the pool is not stable
+
+  */
+
+  // BULLET POOL CLASS
+  class BulletPool
+  {
+    friend class Snapshot;
+
+  protected:
+    std::size_t capacity;
+    std::size_t count;
+    std::vector<StateScalar> positionX;
+    std::vector<StateScalar> positionY;
+    std::vector<StateScalar> velocityX;
+    std::vector<StateScalar> velocityY;
+
+  public:
+    // creates an empty pool able to hold up to maxBullets bullets
+    explicit BulletPool(std::size_t maxBullets);
+
+    // number of live bullets
+    std::size_t size() const { return count; }
+
+    // maximum number of live bullets
+    std::size_t getCapacity() const { return capacity; }
+
+    // removes every bullet
+    void clear();
+
+    // spawns up to n bullets at the given world position with the given velocities copied as-is.
+    // returns the number of bullets actually spawned (fewer than n when the pool is full)
+    std::size_t spawn(double x, double y, const StateScalar *vx, const StateScalar *vy, std::size_t n);
+
+    // spawns up to n bullets at the given world position with the given velocities
+    // rotated by the unit vector (cosAngle, sinAngle).
+    // returns the number of bullets actually spawned (fewer than n when the pool is full)
+    std::size_t spawnRotated(double x, double y, const StateScalar *vx, const StateScalar *vy, std::size_t n, double cosAngle, double sinAngle);
+
+    // simple linear integration of velocity for every bullet
+    void applyVelocity(double deltaTime);
+
+    // removes the bullet at index by moving the last bullet into its slot,
+    // an index past the live bullets is ignored
+    void kill(std::size_t index);
+
+    // removes every bullet whose position is outside of the given rectangle
+    void removeOutside(double minX, double minY, double maxX, double maxY);
+
+    void setPositionX(std::size_t index, double value) { positionX[index] = toState(value); }
+    void setPositionY(std::size_t index, double value) { positionY[index] = toState(value); }
+
+    double getPositionX(std::size_t index) const { return fromState(positionX[index]); }
+    double getPositionY(std::size_t index) const { return fromState(positionY[index]); }
+    double getVelocityX(std::size_t index) const { return fromState(velocityX[index]); }
+    double getVelocityY(std::size_t index) const { return fromState(velocityY[index]); }
+  };
+
+  /*
+
+  BulletPattern
+    - a BulletPattern is a table of bullet velocities relative to an emitter facing along +X
+    - all trigonometry happens once when the pattern is created, never when it is fired
+    - patterns are immutable once created and may be shared by any number of emitters
+
+  */
+
+  // BULLET PATTERN CLASS
+  class BulletPattern
+  {
+  protected:
+    std::vector<StateScalar> velocityX;
+    std::vector<StateScalar> velocityY;
+
+    BulletPattern();
+
+  public:
+    // one bullet straight ahead
+    static BulletPattern single(double speed);
+
+    // count bullets fanned evenly across arcRadians, centered straight ahead
+    static BulletPattern spread(int count, double arcRadians, double speed);
+
+    // count bullets spaced evenly around a full circle, the first one straight ahead
+    static BulletPattern ring(int count, double speed);
+
+    // count bullets straight ahead with speeds stepped evenly from minSpeed to maxSpeed,
+    // so that a single volley leaves the emitter as a short stream
+    static BulletPattern burst(int count, double minSpeed, double maxSpeed);
+
+    // number of bullets in one volley
+    std::size_t size() const { return velocityX.size(); }
+
+    const StateScalar *getVelocitiesX() const { return velocityX.data(); }
+    const StateScalar *getVelocitiesY() const { return velocityY.data(); }
+  };
+
+  /*
+
+  BulletEmitter
+    - a BulletEmitter fires volleys of a BulletPattern into a BulletPool
+    - an emitter only refers to its pattern, which must outlive it; this keeps emitters
+      small and trivially copyable, so entities in a World can carry one as a component
+    - an emitter has an orientation which is kept as a unit vector rather than an angle
+    - an emitter may spin, rotating its orientation by a fixed angle after every volley
+      (a spinning ring is a spiral)
+    - an emitter may fire automatically at a fixed interval when it is updated
+    - any game object (player or enemy) can own an emitter
+
+  */
+
+  // BULLET EMITTER CLASS
+  class BulletEmitter
+  {
+    friend class Snapshot;
+
+  protected:
+    const BulletPattern *pattern;
+    double fireInterval;
+    double fireTime;
+    double orientationX;
+    double orientationY;
+    double spinCos;
+    double spinSin;
+    bool spinning;
+
+    // emits one volley along the given unit vector
+    std::size_t emit(BulletPool &pool, double x, double y, double directionX, double directionY);
+
+  public:
+    // creates an emitter facing along +X which fires the pattern every fireInterval seconds when updated
+    BulletEmitter(const BulletPattern *withPattern, double withFireInterval);
+
+    // fire a different pattern from now on
+    void setPattern(const BulletPattern *withPattern) { pattern = withPattern; }
+
+    // rotate the orientation by radiansPerVolley after every volley (zero disables spinning)
+    void setSpin(double radiansPerVolley);
+
+    // point the emitter at an angle
+    void setOrientation(double radians);
+
+    // point the emitter along a direction vector of any length, without trigonometry.
+    // a zero vector keeps the current orientation
+    void setDirection(double directionX, double directionY);
+
+    // fires one volley from the given world position toward the given target position.
+    // returns the number of bullets spawned
+    std::size_t fireAt(BulletPool &pool, double x, double y, double targetX, double targetY);
+
+    // fires one volley from the given world position along the current orientation.
+    // returns the number of bullets spawned
+    std::size_t fire(BulletPool &pool, double x, double y);
+
+    // advances the firing clock and fires as many volleys as are due along the current orientation.
+    // returns the number of bullets spawned
+    std::size_t update(BulletPool &pool, double x, double y, double deltaTime);
+
+    const BulletPattern &getPattern() const { return *pattern; }
+  };
+}
+
+#endif
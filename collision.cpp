@@ -0,0 +1,123 @@
+#include "collision.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // padding boxes are inside out, so every comparison against them fails
+  constexpr float PADDING_MIN = std::numeric_limits<float>::infinity();
+  constexpr float PADDING_MAX = -std::numeric_limits<float>::infinity();
+
+  // tests box against the LANES boxes starting at first, returning one bit per overlapping box
+  inline std::uint32_t overlapLanes(const Aabb &box, const AabbArray &boxes, std::size_t first)
+  {
+#if defined(__SSE__)
+    __m128 overlapX = _mm_and_ps(
+        _mm_cmplt_ps(_mm_set1_ps(box.minX), _mm_loadu_ps(boxes.getMaxX() + first)),
+        _mm_cmplt_ps(_mm_loadu_ps(boxes.getMinX() + first), _mm_set1_ps(box.maxX)));
+    __m128 overlapY = _mm_and_ps(
+        _mm_cmplt_ps(_mm_set1_ps(box.minY), _mm_loadu_ps(boxes.getMaxY() + first)),
+        _mm_cmplt_ps(_mm_loadu_ps(boxes.getMinY() + first), _mm_set1_ps(box.maxY)));
+    return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_and_ps(overlapX, overlapY)));
+#else
+    std::uint32_t mask = 0;
+    for (std::size_t lane = 0; lane < AabbArray::LANES; ++lane)
+    {
+      std::size_t i = first + lane;
+      bool overlaps = (box.minX < boxes.getMaxX()[i]) & (boxes.getMinX()[i] < box.maxX) &
+                      (box.minY < boxes.getMaxY()[i]) & (boxes.getMinY()[i] < box.maxY);
+      mask |= static_cast<std::uint32_t>(overlaps) << lane;
+    }
+    return mask;
+#endif
+  }
+}
+
+// creates an empty array with room for reserveBoxes boxes
+AabbArray::AabbArray(std::size_t reserveBoxes) : count(0),
+                                                 minX(),
+                                                 minY(),
+                                                 maxX(),
+                                                 maxY()
+{
+  reserve(reserveBoxes);
+}
+
+// makes room for boxes boxes so that adding them does not allocate
+void AabbArray::reserve(std::size_t boxes)
+{
+  std::size_t padded = (boxes + LANES - 1) / LANES * LANES;
+  minX.reserve(padded);
+  minY.reserve(padded);
+  maxX.reserve(padded);
+  maxY.reserve(padded);
+}
+
+// removes every box, keeping the storage
+void AabbArray::clear()
+{
+  count = 0;
+  minX.clear();
+  minY.clear();
+  maxX.clear();
+  maxY.clear();
+}
+
+// appends a box, its index is the number of boxes added before it
+void AabbArray::add(const Aabb &box)
+{
+  if (count == minX.size())
+  {
+    // start a new group of lanes, filled with padding until boxes are added to it
+    minX.insert(minX.end(), LANES, PADDING_MIN);
+    minY.insert(minY.end(), LANES, PADDING_MIN);
+    maxX.insert(maxX.end(), LANES, PADDING_MAX);
+    maxY.insert(maxY.end(), LANES, PADDING_MAX);
+  }
+  minX[count] = box.minX;
+  minY[count] = box.minY;
+  maxX[count] = box.maxX;
+  maxY[count] = box.maxY;
+  ++count;
+}
+
+// tests box against every box in boxes and writes the indices of the ones it overlaps to out
+std::size_t gamelib::overlapOneToMany(const Aabb &box, const AabbArray &boxes, std::uint32_t *out, std::size_t outLength)
+{
+  std::size_t hits = 0;
+  std::size_t padded = boxes.paddedSize();
+  assert(outLength >= padded);
+  for (std::size_t first = 0; first < padded; first += AabbArray::LANES)
+  {
+    std::uint32_t mask = overlapLanes(box, boxes, first);
+
+    // hits are rare, so most groups of lanes are rejected by this one branch
+    while (mask != 0 && hits < outLength)
+    {
+      out[hits++] = static_cast<std::uint32_t>(first + __builtin_ctz(mask));
+      mask &= mask - 1;
+    }
+  }
+  return hits;
+}
+
+// tests box against the 32 boxes starting at first and returns a mask of the overlapping ones
+std::uint32_t gamelib::overlapMask(const Aabb &box, const AabbArray &boxes, std::size_t first)
+{
+  std::uint32_t mask = 0;
+  std::size_t last = std::min(first + 32, boxes.paddedSize());
+  for (std::size_t lanes = first; lanes < last; lanes += AabbArray::LANES)
+  {
+    mask |= overlapLanes(box, boxes, lanes) << (lanes - first);
+  }
+  return mask;
+}
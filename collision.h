@@ -0,0 +1,107 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gamelib
+{
+
+  /*
+
+  Aabb
+    - an axis aligned bounding box given by its minimum and maximum corners
+    - two boxes overlap when they share some area; boxes which only touch along an edge do
+      not overlap (the same rule SDL_IntersectRect uses)
+
+  */
+
+  // AABB STRUCT
+  struct Aabb
+  {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+  };
+
+  /*
+
+  AabbArray
+    - a packed list of boxes stored as four parallel arrays of coordinates
+    - the arrays are always padded to a whole number of LANES with boxes that can never
+      overlap anything, so the overlap kernels never need a scalar tail loop
+    - fill it once per frame from whatever the broadphase produced, then test any number
+      of boxes against it
+
+  */
+
+  // AABB ARRAY CLASS
+  class AabbArray
+  {
+  public:
+    // number of boxes tested together
+    static constexpr std::size_t LANES = 4;
+
+  protected:
+    std::size_t count;
+    std::vector<float> minX;
+    std::vector<float> minY;
+    std::vector<float> maxX;
+    std::vector<float> maxY;
+
+  public:
+    // creates an empty array with room for reserveBoxes boxes
+    explicit AabbArray(std::size_t reserveBoxes = 0);
+
+    // makes room for boxes boxes so that adding them does not allocate
+    void reserve(std::size_t boxes);
+
+    // removes every box, keeping the storage
+    void clear();
+
+    // appends a box, its index is the number of boxes added before it
+    void add(const Aabb &box);
+
+    // number of boxes
+    std::size_t size() const { return count; }
+
+    // number of boxes including the padding
+    std::size_t paddedSize() const { return minX.size(); }
+
+    const float *getMinX() const { return minX.data(); }
+    const float *getMinY() const { return minY.data(); }
+    const float *getMaxX() const { return maxX.data(); }
+    const float *getMaxY() const { return maxY.data(); }
+  };
+
+  // tests box against every box in boxes and writes the indices of the ones it overlaps to out,
+  // which holds outLength indices and must have room for boxes.paddedSize() of them.
+  // returns the number of indices written
+  std::size_t overlapOneToMany(const Aabb &box, const AabbArray &boxes, std::uint32_t *out, std::size_t outLength);
+
+  // tests box against the 32 boxes starting at first (which must be a multiple of
+  // AabbArray::LANES) and returns a mask with bit i set when box first + i overlaps
+  std::uint32_t overlapMask(const Aabb &box, const AabbArray &boxes, std::size_t first);
+
+  // tests every box of group against every box in boxes, calling function(groupIndex, boxIndex)
+  // for each overlapping pair
+  template <typename Function>
+  void overlapGroupToMany(const AabbArray &group, const AabbArray &boxes, Function function)
+  {
+    for (std::size_t groupIndex = 0; groupIndex < group.size(); ++groupIndex)
+    {
+      Aabb box = {group.getMinX()[groupIndex], group.getMinY()[groupIndex], group.getMaxX()[groupIndex], group.getMaxY()[groupIndex]};
+      for (std::size_t first = 0; first < boxes.size(); first += 32)
+      {
+        for (std::uint32_t mask = overlapMask(box, boxes, first); mask != 0; mask &= mask - 1)
+        {
+          function(groupIndex, first + static_cast<std::size_t>(__builtin_ctz(mask)));
+        }
+      }
+    }
+  }
+}
+
+#endif
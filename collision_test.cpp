@@ -0,0 +1,134 @@
+#include "collision.h"
+#include "random.h"
+#include "testing.h"
+
+#include <vector>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // the overlap rule written out one box at a time
+  bool referenceOverlap(const Aabb &a, const Aabb &b)
+  {
+    return a.minX < b.maxX && b.minX < a.maxX && a.minY < b.maxY && b.minY < a.maxY;
+  }
+
+  Aabb randomBox(Random &random)
+  {
+    float x = random.nextFloat(0.0f, 500.0f);
+    float y = random.nextFloat(0.0f, 500.0f);
+    return {x, y, x + random.nextFloat(1.0f, 60.0f), y + random.nextFloat(1.0f, 60.0f)};
+  }
+
+  // the packed kernels find exactly the boxes the reference finds, for counts which do not
+  // fill the last group of lanes
+  void testOneToManyMatchesReference()
+  {
+    Random random(17);
+    for (std::size_t count : {0, 1, 3, 4, 5, 31, 32, 33, 203})
+    {
+      std::vector<Aabb> boxes;
+      AabbArray packed;
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        boxes.push_back(randomBox(random));
+        packed.add(boxes.back());
+      }
+      CHECK(packed.size() == count);
+      CHECK(packed.paddedSize() % AabbArray::LANES == 0 && packed.paddedSize() >= count);
+
+      std::vector<std::uint32_t> hits(packed.paddedSize());
+      bool matches = true;
+      for (int probe = 0; probe < 200; ++probe)
+      {
+        Aabb box = randomBox(random);
+        std::vector<std::uint32_t> expected;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          if (referenceOverlap(box, boxes[i]))
+          {
+            expected.push_back(static_cast<std::uint32_t>(i));
+          }
+        }
+        std::size_t hitCount = overlapOneToMany(box, packed, hits.data(), hits.size());
+        matches &= std::vector<std::uint32_t>(hits.begin(), hits.begin() + hitCount) == expected;
+      }
+      CHECK(matches);
+    }
+  }
+
+  // the group kernel reports every overlapping pair once
+  void testGroupToManyMatchesReference()
+  {
+    Random random(23);
+    std::vector<Aabb> groupBoxes;
+    std::vector<Aabb> boxes;
+    AabbArray group;
+    AabbArray packed;
+    for (int i = 0; i < 37; ++i)
+    {
+      groupBoxes.push_back(randomBox(random));
+      group.add(groupBoxes.back());
+    }
+    for (int i = 0; i < 75; ++i)
+    {
+      boxes.push_back(randomBox(random));
+      packed.add(boxes.back());
+    }
+
+    std::vector<std::vector<bool>> found(groupBoxes.size(), std::vector<bool>(boxes.size(), false));
+    bool noDuplicates = true;
+    overlapGroupToMany(group, packed,
+                       [&](std::size_t groupIndex, std::size_t boxIndex)
+                       {
+                         noDuplicates &= !found[groupIndex][boxIndex];
+                         found[groupIndex][boxIndex] = true;
+                       });
+    CHECK(noDuplicates);
+
+    bool matches = true;
+    for (std::size_t g = 0; g < groupBoxes.size(); ++g)
+    {
+      for (std::size_t b = 0; b < boxes.size(); ++b)
+      {
+        matches &= found[g][b] == referenceOverlap(groupBoxes[g], boxes[b]);
+      }
+    }
+    CHECK(matches);
+  }
+
+  // boxes which only touch along an edge do not overlap
+  void testTouchingBoxesDoNotOverlap()
+  {
+    AabbArray packed;
+    packed.add({10.0f, 0.0f, 20.0f, 10.0f});
+    packed.add({0.0f, 10.0f, 10.0f, 20.0f});
+    std::vector<std::uint32_t> hits(packed.paddedSize());
+    CHECK(overlapOneToMany({0.0f, 0.0f, 10.0f, 10.0f}, packed, hits.data(), hits.size()) == 0);
+    CHECK(overlapOneToMany({9.0f, 9.0f, 11.0f, 11.0f}, packed, hits.data(), hits.size()) == 2);
+  }
+
+  // clear() keeps nothing of the previous boxes
+  void testClearForgetsBoxes()
+  {
+    AabbArray packed(8);
+    packed.add({0.0f, 0.0f, 100.0f, 100.0f});
+    packed.clear();
+    CHECK(packed.size() == 0);
+    CHECK(packed.paddedSize() == 0);
+    packed.add({200.0f, 200.0f, 300.0f, 300.0f});
+    std::vector<std::uint32_t> hits(packed.paddedSize());
+    CHECK(overlapOneToMany({0.0f, 0.0f, 100.0f, 100.0f}, packed, hits.data(), hits.size()) == 0);
+  }
+}
+
+int main()
+{
+  testOneToManyMatchesReference();
+  testGroupToManyMatchesReference();
+  testTouchingBoxesDoNotOverlap();
+  testClearForgetsBoxes();
+  return finishTests("collision");
+}
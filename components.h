@@ -0,0 +1,73 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "scalar.h"
+#include "bullets.h"
+#include "ecs.h"
+
+namespace gamelib
+{
+
+  /*
+
+  the components shared by the game and the benchmark
+    - component ids must never change once assigned, append new components at the end
+    - tags (components without data) take no memory per entity
+
+  */
+
+  // world position
+  struct Position
+  {
+    static constexpr unsigned componentId = 0;
+    StateScalar x;
+    StateScalar y;
+  };
+
+  // velocity in pixels per second
+  struct Velocity
+  {
+    static constexpr unsigned componentId = 1;
+    StateScalar x;
+    StateScalar y;
+  };
+
+  // tag for enemies
+  struct Enemy
+  {
+    static constexpr unsigned componentId = 2;
+  };
+
+  // a bullet emitter fired from the entity's position. the emitter points at its pattern, which
+  // means nothing once the component has been through a snapshot, so the weapon also keeps the
+  // index of its pattern in the game's pattern table to point the emitter back at it
+  struct Weapon
+  {
+    static constexpr unsigned componentId = 3;
+    std::uint32_t patternId;
+    BulletEmitter emitter;
+  };
+
+  // points the emitter of every Weapon at patterns[patternId]; call it after restoring a World
+  // from a snapshot. throws when a weapon names a pattern outside of the table
+  inline void resolveWeaponPatterns(World &world, const BulletPattern *patterns, std::size_t patternCount)
+  {
+    world.each<Weapon>(
+        [&](EntityHandle, Weapon &weapon)
+        {
+          if (weapon.patternId >= patternCount)
+          {
+            throw std::runtime_error("Unable to resolve weapon pattern " + std::to_string(weapon.patternId) +
+                                     ", there are only " + std::to_string(patternCount) + " patterns");
+          }
+          weapon.emitter.setPattern(&patterns[weapon.patternId]);
+        });
+  }
+}
+
+#endif
@@ -0,0 +1,225 @@
+#include "ecs.h"
+
+#include <algorithm>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // rounds value up to the next multiple of alignment
+  inline std::size_t alignUp(std::size_t value, std::size_t alignment)
+  {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+
+  // index of the lowest set bit, the mask must not be zero
+  inline unsigned lowestComponent(ComponentMask mask)
+  {
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+  }
+}
+
+World::World() : components(),
+                 archetypes(),
+                 archetypeLookup(),
+                 records(),
+                 freeRecords(),
+                 liveCount(0) {}
+
+// returns the index of the archetype for the mask, creating it when it does not exist yet
+std::uint32_t World::findOrCreateArchetype(ComponentMask mask)
+{
+  auto found = archetypeLookup.find(mask);
+  if (found != archetypeLookup.end())
+  {
+    return found->second;
+  }
+
+  // work out how many entities fit in a chunk, counting the handle every entity carries
+  std::size_t bytesPerEntity = sizeof(EntityHandle);
+  std::size_t alignmentSlack = 0;
+  for (ComponentMask remaining = mask; remaining != 0; remaining &= remaining - 1)
+  {
+    const ComponentInfo &info = components[lowestComponent(remaining)];
+    if (!info.registered)
+    {
+      throw std::runtime_error("Unable to create archetype with unregistered component id " + std::to_string(lowestComponent(remaining)));
+    }
+    bytesPerEntity += info.size;
+    alignmentSlack += info.alignment - 1;
+  }
+
+  Archetype archetype;
+  archetype.mask = mask;
+  archetype.count = 0;
+  archetype.capacity = CHUNK_BYTES > alignmentSlack ? (CHUNK_BYTES - alignmentSlack) / bytesPerEntity : 0;
+  if (archetype.capacity == 0)
+  {
+    // a component bigger than a chunk, give every entity a chunk of its own
+    archetype.capacity = 1;
+  }
+
+  // the handles come first, then one array per component
+  std::size_t offset = sizeof(EntityHandle) * archetype.capacity;
+  std::fill(std::begin(archetype.offsets), std::end(archetype.offsets), 0);
+  for (ComponentMask remaining = mask; remaining != 0; remaining &= remaining - 1)
+  {
+    unsigned componentId = lowestComponent(remaining);
+    const ComponentInfo &info = components[componentId];
+    if (info.size == 0)
+    {
+      continue;
+    }
+    offset = alignUp(offset, info.alignment);
+    archetype.offsets[componentId] = static_cast<std::uint32_t>(offset);
+    offset += info.size * archetype.capacity;
+  }
+  archetype.chunkBytes = offset;
+
+  archetypes.push_back(std::move(archetype));
+  std::uint32_t index = static_cast<std::uint32_t>(archetypes.size() - 1);
+  archetypeLookup.emplace(mask, index);
+  return index;
+}
+
+// hands out a handle for a new entity, reusing the slot of a destroyed one when possible
+EntityHandle World::allocateHandle()
+{
+  std::uint32_t index;
+  if (!freeRecords.empty())
+  {
+    index = freeRecords.back();
+    freeRecords.pop_back();
+  }
+  else
+  {
+    index = static_cast<std::uint32_t>(records.size());
+    records.push_back({0, 0, 0, 0, false});
+  }
+
+  EntityRecord &record = records[index];
+  record.alive = true;
+  ++liveCount;
+  return {index, record.generation};
+}
+
+// appends a row for the handle to the archetype and records where it went
+void World::allocateRow(std::uint32_t archetypeIndex, EntityHandle handle)
+{
+  Archetype &archetype = archetypes[archetypeIndex];
+  std::size_t chunkIndex = archetype.count / archetype.capacity;
+  std::size_t row = archetype.count % archetype.capacity;
+  if (chunkIndex == archetype.chunks.size())
+  {
+    archetype.chunks.emplace_back(new unsigned char[archetype.chunkBytes]);
+  }
+  ++archetype.count;
+
+  handleColumn(archetype.chunks[chunkIndex].get())[row] = handle;
+
+  EntityRecord &record = records[handle.index];
+  record.archetype = archetypeIndex;
+  record.chunk = static_cast<std::uint32_t>(chunkIndex);
+  record.row = static_cast<std::uint32_t>(row);
+}
+
+// removes a row from an archetype by moving the last row into it
+void World::freeRow(std::uint32_t archetypeIndex, std::uint32_t chunk, std::uint32_t row)
+{
+  Archetype &archetype = archetypes[archetypeIndex];
+  std::size_t last = --archetype.count;
+  std::size_t lastChunk = last / archetype.capacity;
+  std::size_t lastRow = last % archetype.capacity;
+  if (lastChunk == chunk && lastRow == row)
+  {
+    return;
+  }
+
+  unsigned char *to = archetype.chunks[chunk].get();
+  unsigned char *from = archetype.chunks[lastChunk].get();
+  for (ComponentMask remaining = archetype.mask; remaining != 0; remaining &= remaining - 1)
+  {
+    unsigned componentId = lowestComponent(remaining);
+    std::size_t size = components[componentId].size;
+    std::size_t offset = archetype.offsets[componentId];
+    std::memcpy(to + offset + size * row, from + offset + size * lastRow, size);
+  }
+
+  EntityHandle moved = handleColumn(from)[lastRow];
+  handleColumn(to)[row] = moved;
+  records[moved.index].chunk = chunk;
+  records[moved.index].row = row;
+}
+
+// moves an entity to the archetype for newMask, keeping the components both archetypes share
+void World::moveEntity(EntityHandle handle, ComponentMask newMask)
+{
+  // creating the archetype may grow the archetype list, so only hold indices across it
+  std::uint32_t newArchetype = findOrCreateArchetype(newMask);
+  EntityRecord before = records[handle.index];
+  allocateRow(newArchetype, handle);
+  const EntityRecord &after = records[handle.index];
+
+  ComponentMask shared = archetypes[before.archetype].mask & newMask;
+  for (ComponentMask remaining = shared; remaining != 0; remaining &= remaining - 1)
+  {
+    unsigned componentId = lowestComponent(remaining);
+    std::memcpy(componentAddress(after, componentId), componentAddress(before, componentId), components[componentId].size);
+  }
+
+  freeRow(before.archetype, before.chunk, before.row);
+}
+
+// address of one component of one entity
+unsigned char *World::componentAddress(const EntityRecord &record, unsigned componentId)
+{
+  const Archetype &archetype = archetypes[record.archetype];
+  unsigned char *chunk = archetype.chunks[record.chunk].get();
+  return chunk + archetype.offsets[componentId] + static_cast<std::size_t>(components[componentId].size) * record.row;
+}
+
+// destroys an entity, destroying a stale handle does nothing
+void World::destroy(EntityHandle handle)
+{
+  if (!isAlive(handle))
+  {
+    return;
+  }
+
+  EntityRecord &record = records[handle.index];
+  freeRow(record.archetype, record.chunk, record.row);
+  record.alive = false;
+  ++record.generation;
+  freeRecords.push_back(handle.index);
+  --liveCount;
+}
+
+// true when the handle refers to an entity which has not been destroyed
+bool World::isAlive(EntityHandle handle) const
+{
+  return handle.index < records.size() &&
+         records[handle.index].alive &&
+         records[handle.index].generation == handle.generation;
+}
+
+// destroys every entity, keeping the storage for reuse
+void World::clear()
+{
+  for (auto &archetype : archetypes)
+  {
+    archetype.count = 0;
+  }
+  freeRecords.clear();
+  for (std::uint32_t index = static_cast<std::uint32_t>(records.size()); index > 0; --index)
+  {
+    EntityRecord &record = records[index - 1];
+    if (record.alive)
+    {
+      record.alive = false;
+      ++record.generation;
+    }
+    freeRecords.push_back(index - 1);
+  }
+  liveCount = 0;
+}
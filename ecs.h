@@ -0,0 +1,319 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace gamelib
+{
+
+  /*
+
+  Components
+    - a component is a plain struct of data which is safe to copy with memcpy
+    - every component type declares a unique, stable id in the range 0 to 63:
+        struct Position { static constexpr unsigned componentId = 0; double x, y; };
+    - a component without any data members is a tag; tags take no memory per entity
+      and are only used to select which entities a query visits
+
+  */
+
+  // one bit per component id
+  using ComponentMask = std::uint64_t;
+
+  template <typename T>
+  constexpr ComponentMask componentMask()
+  {
+    static_assert(T::componentId < 64, "component ids must be in the range 0 to 63");
+    return ComponentMask(1) << T::componentId;
+  }
+
+  template <typename... Components>
+  constexpr ComponentMask componentMaskOf()
+  {
+    return (ComponentMask(0) | ... | componentMask<Components>());
+  }
+
+  /*
+
+  EntityHandle
+    - refers to an entity in a World
+    - a handle stays valid until its entity is destroyed; the generation makes sure that
+      a stale handle does not refer to a new entity which reuses the same slot
+
+  */
+
+  // ENTITY HANDLE STRUCT
+  struct EntityHandle
+  {
+    std::uint32_t index;
+    std::uint32_t generation;
+
+    bool operator==(const EntityHandle &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const EntityHandle &other) const { return !(*this == other); }
+  };
+
+  /*
+
+  World
+    - stores entities grouped by archetype: the exact set of components an entity has
+    - each archetype stores its entities in fixed size chunks; inside a chunk every component
+      is a separate array (structure of arrays) so that a query walks contiguous memory
+    - entities within an archetype are always packed, removing one moves the last entity
+      of the archetype into its place
+    - chunks are kept when they become empty so that a world which has reached its peak size
+      no longer allocates
+    - adding or removing a component moves the entity to another archetype, which is more
+      expensive than changing component data; do it rarely
+    - entities must not be created, destroyed, or change components during a query;
+      collect handles and apply the changes after the query instead
+
+  */
+
+  // WORLD CLASS
+  class World
+  {
+    friend class Snapshot;
+
+  public:
+    // number of distinct component ids
+    static constexpr std::size_t MAX_COMPONENTS = 64;
+
+    // size of one chunk of entity storage
+    static constexpr std::size_t CHUNK_BYTES = 16 * 1024;
+
+  protected:
+    // COMPONENT INFO STRUCT
+    struct ComponentInfo
+    {
+      std::uint32_t size;
+      std::uint32_t alignment;
+      bool registered;
+    };
+
+    // ARCHETYPE STRUCT
+    struct Archetype
+    {
+      ComponentMask mask;
+      std::size_t capacity;
+      std::size_t chunkBytes;
+      std::size_t count;
+      std::uint32_t offsets[MAX_COMPONENTS];
+      std::vector<std::unique_ptr<unsigned char[]>> chunks;
+    };
+
+    // ENTITY RECORD STRUCT
+    struct EntityRecord
+    {
+      std::uint32_t archetype;
+      std::uint32_t chunk;
+      std::uint32_t row;
+      std::uint32_t generation;
+      bool alive;
+    };
+
+    ComponentInfo components[MAX_COMPONENTS];
+    std::vector<Archetype> archetypes;
+    std::unordered_map<ComponentMask, std::uint32_t> archetypeLookup;
+    std::vector<EntityRecord> records;
+    std::vector<std::uint32_t> freeRecords;
+    std::size_t liveCount;
+
+    // returns the index of the archetype for the mask, creating it when it does not exist yet
+    std::uint32_t findOrCreateArchetype(ComponentMask mask);
+
+    // hands out a handle for a new entity, reusing the slot of a destroyed one when possible
+    EntityHandle allocateHandle();
+
+    // appends a row for the handle to the archetype and records where it went
+    void allocateRow(std::uint32_t archetypeIndex, EntityHandle handle);
+
+    // removes a row from an archetype by moving the last row into it
+    void freeRow(std::uint32_t archetypeIndex, std::uint32_t chunk, std::uint32_t row);
+
+    // moves an entity to the archetype for newMask, keeping the components both archetypes share
+    void moveEntity(EntityHandle handle, ComponentMask newMask);
+
+    // address of one component of one entity
+    unsigned char *componentAddress(const EntityRecord &record, unsigned componentId);
+
+    // the handles stored in a chunk
+    static EntityHandle *handleColumn(unsigned char *chunk) { return reinterpret_cast<EntityHandle *>(chunk); }
+
+    // the array of one component stored in a chunk, tags have no array
+    template <typename T>
+    static T *column(const Archetype &archetype, unsigned char *chunk)
+    {
+      if constexpr (std::is_empty<T>::value)
+      {
+        return nullptr;
+      }
+      else
+      {
+        return reinterpret_cast<T *>(chunk + archetype.offsets[T::componentId]);
+      }
+    }
+
+    // one element of a column, tags share a single instance
+    template <typename T>
+    static T &element(T *columnData, std::size_t row)
+    {
+      if constexpr (std::is_empty<T>::value)
+      {
+        static T tag;
+        return tag;
+      }
+      else
+      {
+        return columnData[row];
+      }
+    }
+
+    template <typename T>
+    void writeComponent(const EntityRecord &record, const T &value)
+    {
+      if constexpr (!std::is_empty<T>::value)
+      {
+        std::memcpy(componentAddress(record, T::componentId), &value, sizeof(T));
+      }
+    }
+
+  public:
+    World();
+
+    // makes a component type known to the world; create and add do this automatically
+    template <typename T>
+    void registerComponent()
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "components must be trivially copyable");
+      static_assert(alignof(T) <= alignof(std::max_align_t), "components must not be over-aligned");
+      ComponentInfo &info = components[T::componentId];
+      std::uint32_t size = std::is_empty<T>::value ? 0 : static_cast<std::uint32_t>(sizeof(T));
+      std::uint32_t alignment = static_cast<std::uint32_t>(alignof(T));
+      if (info.registered && (info.size != size || info.alignment != alignment))
+      {
+        throw std::runtime_error("Two component types share the component id " + std::to_string(T::componentId));
+      }
+      info = {size, alignment, true};
+    }
+
+    // creates an entity with the given components
+    template <typename... Components>
+    EntityHandle create(const Components &...values)
+    {
+      (registerComponent<Components>(), ...);
+      std::uint32_t archetypeIndex = findOrCreateArchetype(componentMaskOf<Components...>());
+      EntityHandle handle = allocateHandle();
+      allocateRow(archetypeIndex, handle);
+      const EntityRecord &record = records[handle.index];
+      (writeComponent(record, values), ...);
+      return handle;
+    }
+
+    // destroys an entity, destroying a stale handle does nothing
+    void destroy(EntityHandle handle);
+
+    // true when the handle refers to an entity which has not been destroyed
+    bool isAlive(EntityHandle handle) const;
+
+    // number of live entities
+    std::size_t size() const { return liveCount; }
+
+    // destroys every entity, keeping the storage for reuse
+    void clear();
+
+    // true when the entity has the component
+    template <typename T>
+    bool has(EntityHandle handle) const
+    {
+      return isAlive(handle) && (archetypes[records[handle.index].archetype].mask & componentMask<T>()) != 0;
+    }
+
+    // the component of an entity, or nullptr when the entity does not have it
+    template <typename T>
+    T *get(EntityHandle handle)
+    {
+      if (!has<T>(handle))
+      {
+        return nullptr;
+      }
+      return &element<T>(reinterpret_cast<T *>(componentAddress(records[handle.index], T::componentId)), 0);
+    }
+
+    // adds a component to an entity, or overwrites it if the entity already has it
+    template <typename T>
+    void add(EntityHandle handle, const T &value)
+    {
+      registerComponent<T>();
+      if (!isAlive(handle))
+      {
+        return;
+      }
+      ComponentMask mask = archetypes[records[handle.index].archetype].mask;
+      if ((mask & componentMask<T>()) == 0)
+      {
+        moveEntity(handle, mask | componentMask<T>());
+      }
+      writeComponent(records[handle.index], value);
+    }
+
+    // removes a component from an entity
+    template <typename T>
+    void remove(EntityHandle handle)
+    {
+      if (!has<T>(handle))
+      {
+        return;
+      }
+      moveEntity(handle, archetypes[records[handle.index].archetype].mask & ~componentMask<T>());
+    }
+
+    // calls function(count, handles, columns...) for every chunk holding entities with all of
+    // the given components; columns of tag components are nullptr
+    template <typename... Components, typename Function>
+    void eachChunk(Function function)
+    {
+      constexpr ComponentMask required = componentMaskOf<Components...>();
+      for (auto &archetype : archetypes)
+      {
+        if ((archetype.mask & required) != required)
+        {
+          continue;
+        }
+        for (std::size_t chunkIndex = 0; chunkIndex * archetype.capacity < archetype.count; ++chunkIndex)
+        {
+          std::size_t rows = archetype.count - chunkIndex * archetype.capacity;
+          if (rows > archetype.capacity)
+          {
+            rows = archetype.capacity;
+          }
+          unsigned char *chunk = archetype.chunks[chunkIndex].get();
+          function(rows, handleColumn(chunk), column<Components>(archetype, chunk)...);
+        }
+      }
+    }
+
+    // calls function(handle, components...) for every entity with all of the given components
+    template <typename... Components, typename Function>
+    void each(Function function)
+    {
+      eachChunk<Components...>(
+          [&](std::size_t rows, EntityHandle *handles, Components *...columns)
+          {
+            for (std::size_t row = 0; row < rows; ++row)
+            {
+              function(handles[row], element<Components>(columns, row)...);
+            }
+          });
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "ecs.h"
+#include "components.h"
+#include "testing.h"
+
+#include <vector>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // a component which claims the id of Position with another size
+  struct Impostor
+  {
+    static constexpr unsigned componentId = Position::componentId;
+    StateScalar x;
+    StateScalar y;
+    StateScalar z;
+  };
+
+  // the same size as Position, but aligned differently
+  struct MisalignedImpostor
+  {
+    static constexpr unsigned componentId = Position::componentId;
+    unsigned char bytes[sizeof(Position)];
+  };
+
+  // created components can be read back and queries visit exactly the matching entities
+  void testCreateAndQuery()
+  {
+    World world;
+    EntityHandle moving = world.create(Position{toState(1), toState(2)}, Velocity{toState(3), toState(4)});
+    EntityHandle still = world.create(Position{toState(5), toState(6)});
+
+    CHECK(world.size() == 2);
+    CHECK(world.isAlive(moving));
+    CHECK(world.has<Velocity>(moving));
+    CHECK(!world.has<Velocity>(still));
+    CHECK(world.get<Position>(still)->x == toState(5));
+    CHECK(world.get<Velocity>(still) == nullptr);
+
+    int visited = 0;
+    world.each<Position, Velocity>(
+        [&](EntityHandle handle, Position &position, Velocity &velocity)
+        {
+          ++visited;
+          CHECK(handle == moving);
+          position.x += velocity.x;
+        });
+    CHECK(visited == 1);
+    CHECK(world.get<Position>(moving)->x == toState(4));
+  }
+
+  // a destroyed entity's slot is reused with a new generation, so old handles stay dead
+  void testDestroyedSlotsAreReusedWithNewGeneration()
+  {
+    World world;
+    EntityHandle first = world.create(Position{toState(1), toState(1)});
+    world.destroy(first);
+    CHECK(!world.isAlive(first));
+    CHECK(world.size() == 0);
+
+    EntityHandle second = world.create(Position{toState(2), toState(2)});
+    CHECK(second.index == first.index);
+    CHECK(second.generation != first.generation);
+    CHECK(!world.isAlive(first));
+    CHECK(world.get<Position>(first) == nullptr);
+
+    // destroying the stale handle again must not touch the new entity
+    world.destroy(first);
+    CHECK(world.isAlive(second));
+    CHECK(world.size() == 1);
+  }
+
+  // removing an entity moves the last one of its archetype into the hole without losing data
+  void testDestroyKeepsOtherEntitiesIntact()
+  {
+    World world;
+    std::vector<EntityHandle> handles;
+    for (int i = 0; i < 2000; ++i)
+    {
+      handles.push_back(world.create(Position{toState(i), toState(-i)}, Enemy{}));
+    }
+    for (int i = 0; i < 2000; i += 3)
+    {
+      world.destroy(handles[i]);
+    }
+
+    bool intact = true;
+    for (int i = 0; i < 2000; ++i)
+    {
+      bool shouldLive = i % 3 != 0;
+      intact &= world.isAlive(handles[i]) == shouldLive;
+      if (shouldLive)
+      {
+        const Position *position = world.get<Position>(handles[i]);
+        intact &= position->x == toState(i) && position->y == toState(-i);
+      }
+    }
+    CHECK(intact);
+
+    int visited = 0;
+    world.each<Position, Enemy>([&](EntityHandle, Position &, Enemy &) { ++visited; });
+    CHECK(static_cast<std::size_t>(visited) == world.size());
+  }
+
+  // adding and removing components moves the entity but keeps the components it had
+  void testAddAndRemoveKeepComponents()
+  {
+    World world;
+    EntityHandle entity = world.create(Position{toState(7), toState(8)});
+    world.add(entity, Velocity{toState(1), toState(1)});
+    CHECK(world.get<Position>(entity)->y == toState(8));
+    CHECK(world.has<Velocity>(entity));
+
+    world.remove<Velocity>(entity);
+    CHECK(!world.has<Velocity>(entity));
+    CHECK(world.get<Position>(entity)->x == toState(7));
+  }
+
+  // clear() kills every handle and keeps the storage for new entities
+  void testClearInvalidatesHandles()
+  {
+    World world;
+    EntityHandle entity = world.create(Position{toState(1), toState(1)});
+    world.clear();
+    CHECK(!world.isAlive(entity));
+    CHECK(world.size() == 0);
+    EntityHandle again = world.create(Position{toState(1), toState(1)});
+    CHECK(world.isAlive(again));
+    CHECK(again != entity);
+  }
+
+  // two types with the same id but another size or alignment are rejected
+  void testConflictingComponentIdsThrow()
+  {
+    World world;
+    world.registerComponent<Position>();
+    CHECK_THROWS(world.registerComponent<Impostor>());
+    CHECK_THROWS(world.registerComponent<MisalignedImpostor>());
+  }
+}
+
+int main()
+{
+  testCreateAndQuery();
+  testDestroyedSlotsAreReusedWithNewGeneration();
+  testDestroyKeepsOtherEntitiesIntact();
+  testAddAndRemoveKeepComponents();
+  testClearInvalidatesHandles();
+  testConflictingComponentIdsThrow();
+  return finishTests("ecs");
+}
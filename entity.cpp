@@ -17,8 +17,8 @@ Entity::Entity() : worldPositionX(0),
                    tags() {}
 
 // specialized constructor - entity will be created at given world position with no velocity
-Entity::Entity(double x, double y) : worldPositionX(x),
-                                     worldPositionY(y),
+Entity::Entity(double x, double y) : worldPositionX(toState(x)),
+                                     worldPositionY(toState(y)),
                                      velocityX(0),
                                      velocityY(0),
                                      id(Entity::nextEntityId++),
@@ -27,10 +27,10 @@ Entity::Entity(double x, double y) : worldPositionX(x),
                                      tags() {}
 
 // specialized constructor - entity will be created at given world position and velocity
-Entity::Entity(double x, double y, double xv, double yv) : worldPositionX(x),
-                                                           worldPositionY(y),
-                                                           velocityX(xv),
-                                                           velocityY(yv),
+Entity::Entity(double x, double y, double xv, double yv) : worldPositionX(toState(x)),
+                                                           worldPositionY(toState(y)),
+                                                           velocityX(toState(xv)),
+                                                           velocityY(toState(yv)),
                                                            id(Entity::nextEntityId++),
                                                            active(true),
                                                            visible(true),
@@ -53,8 +53,8 @@ Entity::Entity(const char *withTags[]) : worldPositionX(0),
 }
 
 // specialized constructor - entity will be created at given world position with no velocity with given tags
-Entity::Entity(double x, double y, const char *withTags[]) : worldPositionX(x),
-                                                             worldPositionY(y),
+Entity::Entity(double x, double y, const char *withTags[]) : worldPositionX(toState(x)),
+                                                             worldPositionY(toState(y)),
                                                              velocityX(0),
                                                              velocityY(0),
                                                              id(Entity::nextEntityId++),
@@ -69,10 +69,10 @@ Entity::Entity(double x, double y, const char *withTags[]) : worldPositionX(x),
 }
 
 // specialized constructor - entity will be created at given world position and velocity with given tags
-Entity::Entity(double x, double y, double xv, double yv, const char *withTags[]) : worldPositionX(x),
-                                                                                   worldPositionY(y),
-                                                                                   velocityX(xv),
-                                                                                   velocityY(yv),
+Entity::Entity(double x, double y, double xv, double yv, const char *withTags[]) : worldPositionX(toState(x)),
+                                                                                   worldPositionY(toState(y)),
+                                                                                   velocityX(toState(xv)),
+                                                                                   velocityY(toState(yv)),
                                                                                    id(Entity::nextEntityId++),
                                                                                    active(true),
                                                                                    visible(true),
@@ -223,10 +223,10 @@ void Entity::applyVelocity(double deltaTime)
   if (active)
   {
     // the entity will move at a rate of velocityX pixels per second along the X axis (horizontal)
-    worldPositionX += velocityX * deltaTime;
+    worldPositionX += velocityX * toState(deltaTime);
 
     // the entity will move at a rate of velocityY pixels per second along the Y axis (vertical)
-    worldPositionY += velocityY * deltaTime;
+    worldPositionY += velocityY * toState(deltaTime);
   }
 }
 
@@ -234,6 +234,6 @@ void Entity::applyVelocity(double deltaTime)
 void Entity::cancelVelocity()
 {
   // this causes the entity to stop moving
-  velocityX = 0.0f;
-  velocityY = 0.0f;
+  velocityX = toState(0.0);
+  velocityY = toState(0.0);
 }
@@ -5,6 +5,8 @@
 #include <string>
 #include <algorithm>
 
+#include "scalar.h"
+
 namespace gamelib
 {
 
@@ -12,8 +14,9 @@ namespace gamelib
 
   Entity
     - every object in the game is an Entity
-    - every Entity has a global world position with double precision
-    - every Entity has a velocity in pixels per second with double precision
+    - every Entity has a global world position stored as a StateScalar
+    - every Entity has a velocity in pixels per second stored as a StateScalar
+    - positions and velocities are read and written as doubles whatever the storage is
     - every Entity has a unique id which is an unsigned long value
     - every Entity has a set of strings which serve as "tags" for identification/grouping
     - every Entity has a boolean flag to determine if the entity is active
@@ -24,15 +27,17 @@ namespace gamelib
   // ENTITY CLASS
   class Entity
   {
+    friend class Snapshot;
+
   private:
     // each time an entity is constructed, the number is incremented
     static unsigned long nextEntityId;
 
   protected:
-    double worldPositionX;
-    double worldPositionY;
-    double velocityX;
-    double velocityY;
+    StateScalar worldPositionX;
+    StateScalar worldPositionY;
+    StateScalar velocityX;
+    StateScalar velocityY;
     unsigned long id;
     bool active;
     bool visible;
@@ -111,15 +116,15 @@ namespace gamelib
     // sets velocity to zero
     void cancelVelocity();
 
-    void setWorldPositionX(double value) { worldPositionX = value; }
-    void setWorldPositionY(double value) { worldPositionY = value; }
-    void setVelocityX(double value) { velocityX = value; }
-    void setVelocityY(double value) { velocityY = value; }
+    void setWorldPositionX(double value) { worldPositionX = toState(value); }
+    void setWorldPositionY(double value) { worldPositionY = toState(value); }
+    void setVelocityX(double value) { velocityX = toState(value); }
+    void setVelocityY(double value) { velocityY = toState(value); }
 
-    double getWorldPositionX() const { return worldPositionX; }
-    double getWorldPositionY() const { return worldPositionY; }
-    double getVelocityX() const { return velocityX; }
-    double getVelocityY() const { return velocityY; }
+    double getWorldPositionX() const { return fromState(worldPositionX); }
+    double getWorldPositionY() const { return fromState(worldPositionY); }
+    double getVelocityX() const { return fromState(velocityX); }
+    double getVelocityY() const { return fromState(velocityY); }
   };
 }
 
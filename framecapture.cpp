@@ -0,0 +1,225 @@
+#include "framecapture.h"
+
+#include <SDL2/SDL_image.h>
+#include <cstdio>
+#include <fstream>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // frames are read back as tightly packed 8 bit RGB, which both formats can write directly
+  constexpr Uint32 CAPTURE_PIXEL_FORMAT = SDL_PIXELFORMAT_RGB24;
+  constexpr int BYTES_PER_PIXEL = 3;
+}
+
+FrameCapture::FrameCapture() : buffers(),
+                               freeBuffers(),
+                               pending(),
+                               pendingHead(0),
+                               pendingCount(0),
+                               pathPrefix(),
+                               format(CaptureFormat::Raw),
+                               interval(1),
+                               frameCounter(0),
+                               stats(),
+                               capturing(false),
+                               stopping(false) {}
+
+// finishes writing every pending frame
+FrameCapture::~FrameCapture()
+{
+  stop();
+}
+
+// starts writing every everyNthFrame frame shown by the renderer to pathPrefix_NNNNNN.ppm or .png
+void FrameCapture::start(SDL_Renderer *renderer, const std::string &withPathPrefix, CaptureFormat withFormat,
+                         int everyNthFrame, std::size_t bufferCount)
+{
+  stop();
+
+  pathPrefix = withPathPrefix;
+  format = withFormat;
+  interval = everyNthFrame > 1 ? static_cast<std::uint64_t>(everyNthFrame) : 1;
+  frameCounter = 0;
+  stats = {0, 0, 0, 0};
+
+  // allocate every buffer now so that capturing frames does not allocate
+  int width = 0;
+  int height = 0;
+  SDL_GetRendererOutputSize(renderer, &width, &height);
+  bufferCount = bufferCount > 0 ? bufferCount : 1;
+  buffers.resize(bufferCount);
+  freeBuffers.clear();
+  for (std::size_t i = 0; i < bufferCount; ++i)
+  {
+    buffers[i].pixels.resize(static_cast<std::size_t>(width) * height * BYTES_PER_PIXEL);
+    buffers[i].width = width;
+    buffers[i].height = height;
+    freeBuffers.push_back(i);
+  }
+  pending.assign(bufferCount, 0);
+  pendingHead = 0;
+  pendingCount = 0;
+
+  stopping = false;
+  capturing = true;
+  worker = std::thread(&FrameCapture::run, this);
+}
+
+// stops capturing once every pending frame has been written
+void FrameCapture::stop()
+{
+  if (!capturing)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  worker.join();
+  capturing = false;
+}
+
+// reads the frame back and queues it for writing, or drops it when no buffer is free
+void FrameCapture::captureFrame(SDL_Renderer *renderer)
+{
+  if (!capturing)
+  {
+    return;
+  }
+  std::uint64_t frame = frameCounter++;
+  if (frame % interval != 0)
+  {
+    return;
+  }
+
+  std::size_t index;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeBuffers.empty())
+    {
+      // the writer is behind, skip this frame rather than wait for it
+      ++stats.dropped;
+      return;
+    }
+    index = freeBuffers.back();
+    freeBuffers.pop_back();
+  }
+
+  // the buffer belongs to this thread until it is queued
+  CaptureBuffer &buffer = buffers[index];
+  int width = 0;
+  int height = 0;
+  SDL_GetRendererOutputSize(renderer, &width, &height);
+  std::size_t bytes = static_cast<std::size_t>(width) * height * BYTES_PER_PIXEL;
+  if (buffer.pixels.size() != bytes)
+  {
+    buffer.pixels.resize(bytes);
+  }
+  buffer.width = width;
+  buffer.height = height;
+  buffer.frame = frame;
+
+  bool readBack = bytes > 0 && SDL_RenderReadPixels(renderer, nullptr, CAPTURE_PIXEL_FORMAT, buffer.pixels.data(), width * BYTES_PER_PIXEL) == 0;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!readBack)
+    {
+      ++stats.failed;
+      freeBuffers.push_back(index);
+      return;
+    }
+    pending[(pendingHead + pendingCount) % pending.size()] = index;
+    ++pendingCount;
+    ++stats.captured;
+  }
+  wake.notify_one();
+}
+
+// the background thread, writes pending buffers until stopped
+void FrameCapture::run()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true)
+  {
+    wake.wait(lock, [this]()
+              { return pendingCount > 0 || stopping; });
+    if (pendingCount == 0)
+    {
+      // stopping, and every frame has been written
+      break;
+    }
+    std::size_t index = pending[pendingHead];
+    pendingHead = (pendingHead + 1) % pending.size();
+    --pendingCount;
+
+    // encode and write without holding the lock so that the game can keep queuing frames
+    lock.unlock();
+    bool written = writeFrame(buffers[index]);
+    lock.lock();
+
+    if (written)
+    {
+      ++stats.written;
+    }
+    else
+    {
+      ++stats.failed;
+    }
+    freeBuffers.push_back(index);
+  }
+}
+
+// encodes and writes one buffer, returns false when it could not be written
+bool FrameCapture::writeFrame(const CaptureBuffer &buffer) const
+{
+  char number[32];
+  std::snprintf(number, sizeof(number), "_%06llu", static_cast<unsigned long long>(buffer.frame));
+  std::string path = pathPrefix + number + (format == CaptureFormat::Png ? ".png" : ".ppm");
+
+  if (format == CaptureFormat::Png)
+  {
+    // the surface only wraps the buffer, IMG_SavePNG does the encoding
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(
+        const_cast<unsigned char *>(buffer.pixels.data()),
+        buffer.width,
+        buffer.height,
+        BYTES_PER_PIXEL * 8,
+        buffer.width * BYTES_PER_PIXEL,
+        CAPTURE_PIXEL_FORMAT);
+    if (!surface)
+    {
+      return false;
+    }
+    bool saved = IMG_SavePNG(surface, path.c_str()) == 0;
+    SDL_FreeSurface(surface);
+    return saved;
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  file << "P6\n"
+       << buffer.width << " " << buffer.height << "\n255\n";
+  file.write(reinterpret_cast<const char *>(buffer.pixels.data()), static_cast<std::streamsize>(buffer.pixels.size()));
+  return static_cast<bool>(file);
+}
+
+CaptureStats FrameCapture::getStats() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+// prints the capture counts
+void FrameCapture::report(std::ostream &out) const
+{
+  CaptureStats counts = getStats();
+  out << "captured frames: " << counts.captured
+      << " written: " << counts.written
+      << " dropped: " << counts.dropped
+      << " failed: " << counts.failed << std::endl;
+}
@@ -0,0 +1,128 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <SDL2/SDL.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gamelib
+{
+
+  // how captured frames are written
+  enum class CaptureFormat
+  {
+    // binary PPM: the raw RGB pixels behind a short text header, cheap to write
+    Raw,
+    // PNG through SDL_image, smaller files but slower to encode
+    Png
+  };
+
+  /*
+
+  FrameCapture
+    - records what the renderer shows as a numbered image sequence (prefix_000042.png)
+    - captureFrame() must be called before the frame is presented; it reads the pixels back
+      into one of a fixed pool of buffers and hands the buffer to a background thread which
+      encodes and writes it, then returns the buffer to the pool
+    - when every buffer is still waiting to be written the frame is dropped instead of
+      waiting, so a slow disk never slows down the game; the gaps show in the frame numbers
+    - the read back itself still happens on the calling thread and waits for the renderer to
+      finish the frame, capture every Nth frame to make that cheaper
+    - buffers are allocated when capturing starts, capturing a frame only allocates when the
+      size of the output changes
+    - works with the software renderer, so a hidden window can be captured in headless runs
+
+  */
+
+  // CAPTURE STATS STRUCT
+  struct CaptureStats
+  {
+    // frames read back and queued for writing
+    std::uint64_t captured;
+    // frames skipped because no buffer was free
+    std::uint64_t dropped;
+    // frames written to disk
+    std::uint64_t written;
+    // frames which could not be read back or written
+    std::uint64_t failed;
+  };
+
+  // FRAME CAPTURE CLASS
+  class FrameCapture
+  {
+  public:
+    // number of frames which can wait to be written at once
+    static constexpr std::size_t DEFAULT_BUFFERS = 4;
+
+  protected:
+    // CAPTURE BUFFER STRUCT
+    struct CaptureBuffer
+    {
+      std::vector<unsigned char> pixels;
+      int width;
+      int height;
+      std::uint64_t frame;
+    };
+
+    std::vector<CaptureBuffer> buffers;
+    std::vector<std::size_t> freeBuffers;
+    // indices of buffers waiting to be written, oldest first, in a ring
+    std::vector<std::size_t> pending;
+    std::size_t pendingHead;
+    std::size_t pendingCount;
+
+    std::string pathPrefix;
+    CaptureFormat format;
+    std::uint64_t interval;
+    std::uint64_t frameCounter;
+    CaptureStats stats;
+    bool capturing;
+    bool stopping;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+
+    // the background thread, writes pending buffers until stopped
+    void run();
+
+    // encodes and writes one buffer, returns false when it could not be written
+    bool writeFrame(const CaptureBuffer &buffer) const;
+
+  public:
+    FrameCapture();
+
+    // finishes writing every pending frame
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture &other) = delete;
+    FrameCapture &operator=(const FrameCapture &other) = delete;
+
+    // starts writing every everyNthFrame frame shown by the renderer to pathPrefix_NNNNNN.ppm or .png,
+    // with bufferCount frames allowed to wait for the disk
+    void start(SDL_Renderer *renderer, const std::string &withPathPrefix, CaptureFormat withFormat,
+               int everyNthFrame = 1, std::size_t bufferCount = DEFAULT_BUFFERS);
+
+    // stops capturing once every pending frame has been written
+    void stop();
+
+    bool isCapturing() const { return capturing; }
+
+    // reads the frame back and queues it for writing, or drops it when no buffer is free.
+    // call before presenting, the contents of the renderer are undefined afterwards
+    void captureFrame(SDL_Renderer *renderer);
+
+    CaptureStats getStats() const;
+
+    // prints the capture counts
+    void report(std::ostream &out) const;
+  };
+}
+
+#endif
@@ -0,0 +1,167 @@
+#include "framecapture.h"
+#include "testing.h"
+
+#include <SDL2/SDL.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <sys/stat.h>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  const std::string PREFIX = "framecapture_test";
+
+  // the file a frame is written to
+  std::string framePath(int frame)
+  {
+    char number[32];
+    std::snprintf(number, sizeof(number), "_%06d.ppm", frame);
+    return PREFIX + number;
+  }
+
+  // reads a fifo until the writer closes it
+  void drainFifo(const std::string &path)
+  {
+    std::ifstream fifo(path, std::ios::binary);
+    char bytes[4096];
+    while (fifo.read(bytes, sizeof(bytes)) || fifo.gcount() > 0)
+    {
+    }
+  }
+
+  // a software renderer drawing into memory, which needs no window or display
+  // RENDER TARGET STRUCT
+  struct RenderTarget
+  {
+    SDL_Surface *surface;
+    SDL_Renderer *renderer;
+
+    RenderTarget() : surface(SDL_CreateRGBSurfaceWithFormat(0, 64, 48, 32, SDL_PIXELFORMAT_ARGB8888)),
+                     renderer(surface ? SDL_CreateSoftwareRenderer(surface) : nullptr) {}
+
+    ~RenderTarget()
+    {
+      if (renderer)
+      {
+        SDL_DestroyRenderer(renderer);
+      }
+      if (surface)
+      {
+        SDL_FreeSurface(surface);
+      }
+    }
+  };
+
+  // every captured frame is written, and only every Nth frame is captured
+  void testCapturesEveryNthFrame()
+  {
+    RenderTarget target;
+    CHECK(target.renderer != nullptr);
+
+    FrameCapture capture;
+    capture.start(target.renderer, PREFIX, CaptureFormat::Raw, 3, 8);
+    for (int frame = 0; frame < 9; ++frame)
+    {
+      capture.captureFrame(target.renderer);
+    }
+    capture.stop();
+
+    // three frames never need more than the eight buffers, so none are dropped
+    CaptureStats stats = capture.getStats();
+    CHECK(stats.captured == 3);
+    CHECK(stats.dropped == 0);
+    CHECK(stats.written == 3);
+    CHECK(stats.failed == 0);
+    for (int frame = 0; frame < 9; frame += 3)
+    {
+      std::ifstream file(framePath(frame), std::ios::binary);
+      std::string magic;
+      file >> magic;
+      CHECK(magic == "P6");
+      std::remove(framePath(frame).c_str());
+    }
+  }
+
+  // while the writer is stuck every frame which needs a buffer is dropped instead of waiting
+  void testDropsFramesWhileTheWriterIsBusy()
+  {
+    RenderTarget target;
+
+    // opening a fifo for writing blocks until it is read, which holds the only buffer
+    std::remove(framePath(0).c_str());
+    CHECK(mkfifo(framePath(0).c_str(), 0600) == 0);
+
+    FrameCapture capture;
+    capture.start(target.renderer, PREFIX, CaptureFormat::Raw, 1, 1);
+    for (int frame = 0; frame < 10; ++frame)
+    {
+      capture.captureFrame(target.renderer);
+    }
+
+    CaptureStats stats = capture.getStats();
+    CHECK(stats.captured == 1);
+    CHECK(stats.dropped == 9);
+    CHECK(stats.written == 0);
+
+    // drain the fifo so that the writer can finish
+    std::thread reader(drainFifo, framePath(0));
+    capture.stop();
+    reader.join();
+    std::remove(framePath(0).c_str());
+
+    stats = capture.getStats();
+    CHECK(stats.written == 1);
+    CHECK(stats.dropped == 9);
+    CHECK(!capture.isCapturing());
+  }
+
+  // frames which cannot be written are counted as failed and their buffers reused
+  void testCountsFailedWrites()
+  {
+    RenderTarget target;
+
+    FrameCapture capture;
+    capture.start(target.renderer, "framecapture_test_missing_directory/frame", CaptureFormat::Raw, 1, 2);
+    for (int frame = 0; frame < 4; ++frame)
+    {
+      capture.captureFrame(target.renderer);
+    }
+    capture.stop();
+
+    CaptureStats stats = capture.getStats();
+    CHECK(stats.written == 0);
+    CHECK(stats.failed == stats.captured);
+    CHECK(stats.captured + stats.dropped == 4);
+  }
+
+  // capturing before start() or after stop() does nothing
+  void testIgnoresFramesWhenStopped()
+  {
+    RenderTarget target;
+    FrameCapture capture;
+    capture.captureFrame(target.renderer);
+    CaptureStats stats = capture.getStats();
+    CHECK(stats.captured == 0 && stats.dropped == 0);
+    CHECK(!capture.isCapturing());
+
+    capture.start(target.renderer, "framecapture_test_missing_directory/frame", CaptureFormat::Raw);
+    capture.stop();
+    capture.captureFrame(target.renderer);
+    stats = capture.getStats();
+    CHECK(stats.captured == 0 && stats.dropped == 0);
+  }
+}
+
+int main()
+{
+  testCapturesEveryNthFrame();
+  testDropsFramesWhileTheWriterIsBusy();
+  testCountsFailedWrites();
+  testIgnoresFramesWhenStopped();
+  return finishTests("framecapture");
+}
@@ -0,0 +1,142 @@
+#include "framepacer.h"
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+// starts in TargetFps mode at 60 frames per second
+FramePacer::FramePacer() : mode(FrameMode::TargetFps),
+                           targetPeriod(1.0 / 60.0),
+                           spinThreshold(0.002),
+                           counterFrequency(static_cast<double>(SDL_GetPerformanceFrequency()))
+{
+  reset();
+}
+
+void FramePacer::setMode(FrameMode withMode)
+{
+  mode = withMode;
+  reset();
+}
+
+// frames per second used by TargetFps mode, and to count late frames in VSync mode
+void FramePacer::setTargetFps(double fps)
+{
+  targetPeriod = fps > 0.0 ? 1.0 / fps : 1.0 / 60.0;
+  reset();
+}
+
+// how close to the deadline the pacer stops sleeping and starts spinning
+void FramePacer::setSpinThreshold(double seconds)
+{
+  spinThreshold = std::max(seconds, 0.0);
+}
+
+// measures the next frame from now, so work done since endFrame() is not counted
+void FramePacer::beginFrame()
+{
+  lastFrameCounter = SDL_GetPerformanceCounter();
+}
+
+// waits until the next frame is due (TargetFps mode only) and measures the frame
+void FramePacer::endFrame()
+{
+  std::uint64_t now = SDL_GetPerformanceCounter();
+
+  if (mode == FrameMode::TargetFps)
+  {
+    std::uint64_t period = static_cast<std::uint64_t>(targetPeriod * counterFrequency);
+    deadline += period;
+
+    if (now > deadline + period)
+    {
+      // more than a frame behind, start again from now rather than rushing to catch up
+      deadline = now;
+    }
+
+    // sleep away most of the wait, leaving the last stretch to the spin loop
+    std::uint64_t spinTicks = static_cast<std::uint64_t>(spinThreshold * counterFrequency);
+    if (now + spinTicks < deadline)
+    {
+      double sleepSeconds = static_cast<double>(deadline - spinTicks - now) / counterFrequency;
+      SDL_Delay(static_cast<Uint32>(sleepSeconds * 1000.0));
+    }
+
+    now = SDL_GetPerformanceCounter();
+    while (now < deadline)
+    {
+      now = SDL_GetPerformanceCounter();
+    }
+  }
+
+  measure(now);
+}
+
+// records the time since the previous frame ended
+void FramePacer::measure(std::uint64_t now)
+{
+  double frameTime = static_cast<double>(now - lastFrameCounter) / counterFrequency;
+  lastFrameCounter = now;
+
+  ++frames;
+  double delta = frameTime - mean;
+  mean += delta / static_cast<double>(frames);
+  squaredDeviations += delta * (frameTime - mean);
+  minFrame = std::min(minFrame, frameTime);
+  maxFrame = std::max(maxFrame, frameTime);
+
+  if (mode != FrameMode::Uncapped && frameTime > targetPeriod * 1.5)
+  {
+    ++lateFrames;
+  }
+}
+
+// forgets every measured frame and restarts the deadlines from now
+void FramePacer::reset()
+{
+  deadline = SDL_GetPerformanceCounter();
+  lastFrameCounter = deadline;
+  frames = 0;
+  mean = 0.0;
+  squaredDeviations = 0.0;
+  minFrame = std::numeric_limits<double>::infinity();
+  maxFrame = 0.0;
+  lateFrames = 0;
+}
+
+FrameStats FramePacer::getStats() const
+{
+  FrameStats stats;
+  stats.frames = frames;
+  stats.meanSeconds = mean;
+  stats.minSeconds = frames > 0 ? minFrame : 0.0;
+  stats.maxSeconds = maxFrame;
+  stats.jitterSeconds = frames > 1 ? std::sqrt(squaredDeviations / static_cast<double>(frames - 1)) : 0.0;
+  stats.lateFrames = lateFrames;
+  return stats;
+}
+
+// prints the frame time statistics
+void FramePacer::report(std::ostream &out) const
+{
+  static const char *modeNames[] = {"vsync", "target fps", "uncapped"};
+
+  FrameStats stats = getStats();
+  out << "frame mode: " << modeNames[static_cast<int>(mode)];
+  if (mode != FrameMode::Uncapped)
+  {
+    out << " (" << getTargetFps() << " fps target)";
+  }
+  out << std::endl;
+  out << "frames: " << stats.frames
+      << " mean: " << stats.meanSeconds * 1000.0 << " ms"
+      << " (" << (stats.meanSeconds > 0.0 ? 1.0 / stats.meanSeconds : 0.0) << " fps)" << std::endl;
+  out << "min: " << stats.minSeconds * 1000.0 << " ms"
+      << " max: " << stats.maxSeconds * 1000.0 << " ms"
+      << " jitter: " << stats.jitterSeconds * 1000.0 << " ms"
+      << " late frames: " << stats.lateFrames << std::endl;
+}
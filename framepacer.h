@@ -0,0 +1,103 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <cstdint>
+#include <iostream>
+
+namespace gamelib
+{
+
+  // how the frame pacer decides when the next frame may start
+  enum class FrameMode
+  {
+    // the renderer waits for the display refresh when presenting
+    VSync,
+    // the pacer sleeps, then spins, until the next frame is due
+    TargetFps,
+    // frames run back to back as fast as possible (benchmarks)
+    Uncapped
+  };
+
+  /*
+
+  FramePacer
+    - call endFrame() once per frame, right after presenting
+    - in TargetFps mode endFrame() waits until the next frame is due: it sleeps with
+      SDL_Delay while the deadline is further away than the spin threshold (SDL_Delay can
+      oversleep by a millisecond or more), then spins on the performance counter for the rest
+    - deadlines advance by a fixed period so that an early or late frame does not shift the
+      following ones; when the game falls more than a frame behind the deadline is reset
+      instead of trying to catch up with a burst of frames
+    - the pacer does not touch the renderer, so in VSync mode Window enables vsync and
+      endFrame() only measures
+    - every frame time is measured with the performance counter and summarized as mean,
+      minimum, maximum and jitter (standard deviation of the frame time)
+
+  */
+
+  // FRAME STATS STRUCT
+  struct FrameStats
+  {
+    std::uint64_t frames;
+    double meanSeconds;
+    double minSeconds;
+    double maxSeconds;
+    double jitterSeconds;
+    // frames which took more than one and a half target periods (TargetFps and VSync only)
+    std::uint64_t lateFrames;
+  };
+
+  // FRAME PACER CLASS
+  class FramePacer
+  {
+  protected:
+    FrameMode mode;
+    double targetPeriod;
+    double spinThreshold;
+    double counterFrequency;
+    std::uint64_t deadline;
+    std::uint64_t lastFrameCounter;
+
+    // running frame time statistics (Welford's method keeps the variance stable)
+    std::uint64_t frames;
+    double mean;
+    double squaredDeviations;
+    double minFrame;
+    double maxFrame;
+    std::uint64_t lateFrames;
+
+    // records the time since the previous frame ended
+    void measure(std::uint64_t now);
+
+  public:
+    // starts in TargetFps mode at 60 frames per second
+    FramePacer();
+
+    void setMode(FrameMode withMode);
+    FrameMode getMode() const { return mode; }
+
+    // frames per second used by TargetFps mode, and to count late frames in VSync mode
+    void setTargetFps(double fps);
+    double getTargetFps() const { return 1.0 / targetPeriod; }
+
+    // how close to the deadline the pacer stops sleeping and starts spinning (default 2ms)
+    void setSpinThreshold(double seconds);
+
+    // measures the next frame from now, so work done since endFrame() is not counted
+    // (TargetFps deadlines are not affected)
+    void beginFrame();
+
+    // waits until the next frame is due (TargetFps mode only) and measures the frame
+    void endFrame();
+
+    // forgets every measured frame and restarts the deadlines from now
+    void reset();
+
+    FrameStats getStats() const;
+
+    // prints the frame time statistics
+    void report(std::ostream &out) const;
+  };
+}
+
+#endif
@@ -0,0 +1,138 @@
+#include "framepacer.h"
+#include "testing.h"
+
+#include <SDL2/SDL.h>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // seconds since counter, measured with the same clock as the pacer
+  double secondsSince(Uint64 counter)
+  {
+    return static_cast<double>(SDL_GetPerformanceCounter() - counter) / static_cast<double>(SDL_GetPerformanceFrequency());
+  }
+
+  // bounds are loose so that a busy machine does not fail the tests; they only catch a pacer
+  // which does not wait at all or waits far too long
+
+  // TargetFps spaces frames one period apart
+  void testTargetFpsWaitsForEachFrame()
+  {
+    FramePacer pacer;
+    pacer.setMode(FrameMode::TargetFps);
+    pacer.setTargetFps(100.0);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < 20; ++frame)
+    {
+      pacer.endFrame();
+    }
+    double elapsed = secondsSince(start);
+    FrameStats stats = pacer.getStats();
+
+    CHECK(stats.frames == 20);
+    CHECK(elapsed >= 0.19);
+    CHECK(elapsed < 0.6);
+    CHECK(stats.meanSeconds >= 0.0095);
+    CHECK(stats.minSeconds <= stats.meanSeconds && stats.meanSeconds <= stats.maxSeconds);
+  }
+
+  // a frame which falls behind is late, and the pacer does not rush the following frames
+  void testTargetFpsDoesNotCatchUp()
+  {
+    FramePacer pacer;
+    pacer.setMode(FrameMode::TargetFps);
+    pacer.setTargetFps(100.0);
+
+    pacer.endFrame();
+    std::uint64_t lateBefore = pacer.getStats().lateFrames;
+    SDL_Delay(50);
+    pacer.endFrame();
+    CHECK(pacer.getStats().lateFrames == lateBefore + 1);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    pacer.endFrame();
+    pacer.endFrame();
+    CHECK(secondsSince(start) >= 0.0095);
+  }
+
+  // Uncapped never waits and never counts late frames
+  void testUncappedDoesNotWait()
+  {
+    FramePacer pacer;
+    pacer.setMode(FrameMode::Uncapped);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < 1000; ++frame)
+    {
+      pacer.endFrame();
+    }
+    CHECK(secondsSince(start) < 0.1);
+
+    SDL_Delay(40);
+    pacer.endFrame();
+    CHECK(pacer.getStats().frames == 1001);
+    CHECK(pacer.getStats().lateFrames == 0);
+  }
+
+  // VSync leaves the waiting to the renderer, the pacer only measures and counts late frames
+  void testVSyncOnlyMeasures()
+  {
+    FramePacer pacer;
+    pacer.setMode(FrameMode::VSync);
+    pacer.setTargetFps(60.0);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    pacer.endFrame();
+    CHECK(secondsSince(start) < 0.01);
+
+    std::uint64_t lateBefore = pacer.getStats().lateFrames;
+    SDL_Delay(40);
+    pacer.endFrame();
+    CHECK(pacer.getStats().lateFrames == lateBefore + 1);
+  }
+
+  // work done between endFrame() and beginFrame() is left out of the measurement
+  void testBeginFrameExcludesEarlierWork()
+  {
+    FramePacer pacer;
+    pacer.setMode(FrameMode::Uncapped);
+
+    SDL_Delay(30);
+    pacer.beginFrame();
+    pacer.endFrame();
+    CHECK(pacer.getStats().maxSeconds < 0.02);
+  }
+
+  // reset() forgets every frame, and a target of zero falls back to 60 fps
+  void testResetAndDefaults()
+  {
+    FramePacer pacer;
+    CHECK(pacer.getMode() == FrameMode::TargetFps);
+    CHECK(pacer.getTargetFps() > 59.9 && pacer.getTargetFps() < 60.1);
+
+    pacer.setMode(FrameMode::Uncapped);
+    pacer.endFrame();
+    pacer.endFrame();
+    pacer.reset();
+    FrameStats stats = pacer.getStats();
+    CHECK(stats.frames == 0);
+    CHECK(stats.minSeconds == 0.0 && stats.maxSeconds == 0.0 && stats.jitterSeconds == 0.0);
+
+    pacer.setTargetFps(0.0);
+    CHECK(pacer.getTargetFps() > 59.9 && pacer.getTargetFps() < 60.1);
+  }
+}
+
+int main()
+{
+  testTargetFpsWaitsForEachFrame();
+  testTargetFpsDoesNotCatchUp();
+  testUncappedDoesNotWait();
+  testVSyncOnlyMeasures();
+  testBeginFrameExcludesEarlierWork();
+  testResetAndDefaults();
+  return finishTests("framepacer");
+}
@@ -1,5 +1,12 @@
 #include "window.h"
 #include "entity.h"
+#include "ecs.h"
+#include "components.h"
+#include "collision.h"
+#include "bullets.h"
+#include "particles.h"
+#include "alloctracker.h"
+#include "snapshot.h"
 
 constexpr int WIDTH = 800;
 constexpr int HEIGHT = 600;
@@ -11,6 +18,7 @@ constexpr double PLAYER_SPEED = 400;
 constexpr int PLAYER_PROJECTILE_WIDTH = 8;
 constexpr int PLAYER_PROJECTILE_HEIGHT = 8;
 constexpr double PLAYER_PROJECTILE_SPEED = 500;
+constexpr int MAX_PLAYER_PROJECTILES = 4096;
 
 constexpr int NUM_ENEMIES = 25;
 
@@ -18,6 +26,18 @@ constexpr int ENEMY_WIDTH = 50;
 constexpr int ENEMY_HEIGHT = 50;
 constexpr double ENEMY_SPEED = 180;
 
+// every ENEMY_WEAPON_EVERY-th enemy carries a weapon aimed at the player
+constexpr int ENEMY_WEAPON_EVERY = 5;
+constexpr double ENEMY_FIRE_INTERVAL = 1.5;
+constexpr int ENEMY_PROJECTILE_SIZE = 6;
+constexpr double ENEMY_PROJECTILE_SPEED = 200;
+constexpr int MAX_ENEMY_PROJECTILES = 1024;
+
+// index of the enemy pattern in the table of weapon patterns
+constexpr std::uint32_t ENEMY_WEAPON_PATTERN = 0;
+
+constexpr int MAX_PARTICLES = 20000;
+
 int main()
 {
   std::cout << "creating window" << std::endl;
@@ -30,54 +50,77 @@ int main()
   window.keymap.emplace("left", SDL_SCANCODE_LEFT);
   window.keymap.emplace("right", SDL_SCANCODE_RIGHT);
   window.keymap.emplace("fire", SDL_SCANCODE_SPACE);
+  window.keymap.emplace("restart", SDL_SCANCODE_R);
+  window.keymap.emplace("capture", SDL_SCANCODE_F12);
 
-  auto setRandomPosition = [&](gamelib::Entity &entity)
-  {
-    entity.setWorldPositionX(window.getRandomInRangeInt(0, WIDTH));
-    entity.setWorldPositionY(window.getRandomInRangeInt(0, HEIGHT));
-  };
+  std::cout << "creating entities.." << std::endl;
+  gamelib::World world;
+  gamelib::BulletPool projectiles(MAX_PLAYER_PROJECTILES);
+  gamelib::BulletPool enemyProjectiles(MAX_ENEMY_PROJECTILES);
 
-  auto setRandomVelocity = [&](gamelib::Entity &entity, double speed)
-  {
-    entity.setVelocityX(window.getRandomInRangeDouble(-1, 1) * speed);
-    entity.setVelocityY(window.getRandomInRangeDouble(-1, 1) * speed);
-  };
+  // patterns are shared by every emitter which fires them and must outlive the emitters
+  gamelib::BulletPattern playerPattern = gamelib::BulletPattern::single(PLAYER_PROJECTILE_SPEED);
+
+  // enemy weapons name their pattern by its index in this table, which survives a snapshot
+  std::vector<gamelib::BulletPattern> weaponPatterns = {gamelib::BulletPattern::spread(3, 0.4, ENEMY_PROJECTILE_SPEED)};
 
-  std::cout << "creating entities.." << std::endl;
-  std::vector<std::unique_ptr<gamelib::Entity>> enemies;
-  std::vector<std::unique_ptr<gamelib::Entity>> projectiles;
   std::cout << "creating player entity" << std::endl;
   gamelib::Entity player(WIDTH * 0.5, HEIGHT * 0.5, (const char *[]){"Player", nullptr});
 
   std::cout << "creating enemy entities" << std::endl;
 
+  // roll the random spawn positions and velocities for the whole wave at once
+  std::vector<int> spawnX(NUM_ENEMIES);
+  std::vector<int> spawnY(NUM_ENEMIES);
+  std::vector<double> spawnVelocityX(NUM_ENEMIES);
+  std::vector<double> spawnVelocityY(NUM_ENEMIES);
+  window.getRandom().fillInt(spawnX.data(), NUM_ENEMIES, 0, WIDTH);
+  window.getRandom().fillInt(spawnY.data(), NUM_ENEMIES, 0, HEIGHT);
+  window.getRandom().fillDouble(spawnVelocityX.data(), NUM_ENEMIES, -ENEMY_SPEED, ENEMY_SPEED);
+  window.getRandom().fillDouble(spawnVelocityY.data(), NUM_ENEMIES, -ENEMY_SPEED, ENEMY_SPEED);
+
   for (int i = 0; i < NUM_ENEMIES; i++)
   {
-    auto enemy = std::make_unique<gamelib::Entity>((const char *[]){"Enemy", nullptr});
+    gamelib::EntityHandle enemy = world.create(
+        gamelib::Position{gamelib::toState(spawnX[i]), gamelib::toState(spawnY[i])},
+        gamelib::Velocity{gamelib::toState(spawnVelocityX[i]), gamelib::toState(spawnVelocityY[i])},
+        gamelib::Enemy{});
+    if (i % ENEMY_WEAPON_EVERY == 0)
+    {
+      world.add(enemy, gamelib::Weapon{ENEMY_WEAPON_PATTERN, gamelib::BulletEmitter(&weaponPatterns[ENEMY_WEAPON_PATTERN], ENEMY_FIRE_INTERVAL)});
+    }
+  }
 
-    setRandomPosition(*(enemy.get()));
-    setRandomVelocity(*(enemy.get()), ENEMY_SPEED);
+  // enemies hit during the collision pass are destroyed once the pass is over. an enemy hit by
+  // several projectiles in one frame is only queued once, so the queue never outgrows the wave
+  std::vector<gamelib::EntityHandle> deadEnemies;
+  deadEnemies.reserve(NUM_ENEMIES);
+  std::vector<std::uint8_t> isEnemyQueued;
+  isEnemyQueued.reserve(NUM_ENEMIES);
 
-    enemies.push_back(std::move(enemy));
-  }
+  // enemy bounding boxes packed for the collision pass, with the handle of each box
+  gamelib::AabbArray enemyBoxes(NUM_ENEMIES);
+  std::vector<gamelib::EntityHandle> enemyHandles;
+  enemyHandles.reserve(NUM_ENEMIES);
+  // sized to the padded box count every frame
+  std::vector<std::uint32_t> enemyHits;
+
+  std::cout << "creating particle system" << std::endl;
+  gamelib::ParticleSystem particles(MAX_PARTICLES);
+  particles.setDrag(2.0f);
+
+  // count, min speed, max speed, min lifetime, max lifetime, size, red, green, blue
+  int explosionEmitter = particles.createEmitter({120, 40.0f, 260.0f, 0.4f, 1.2f, 4.0f, 255, 160, 32}, MAX_PARTICLES / 2);
+  int sparkEmitter = particles.createEmitter({16, 80.0f, 320.0f, 0.1f, 0.3f, 2.0f, 255, 255, 192}, MAX_PARTICLES / 4);
 
   float firingRate = 0.1f;
   float firingTime = 0.0f;
 
+  gamelib::BulletEmitter playerWeapon(&playerPattern, 0);
+
   auto fireWeaponAtTarget = [&](double weaponX, double weaponY, double targetX, double targetY)
   {
-    double angleToTarget = atan2(targetY - weaponY, targetX - weaponX);
-    double projectileVelocityX = cos(angleToTarget) * PLAYER_PROJECTILE_SPEED;
-    double projectileVelocityY = sin(angleToTarget) * PLAYER_PROJECTILE_SPEED;
-
-    auto projectile = std::make_unique<gamelib::Entity>(
-        weaponX,
-        weaponY,
-        projectileVelocityX,
-        projectileVelocityY,
-        (const char *[]){"Projectile", "Player", nullptr});
-
-    projectiles.push_back(std::move(projectile));
+    playerWeapon.fireAt(projectiles, weaponX, weaponY, targetX, targetY);
   };
 
   bool isMouseDown = false;
@@ -185,42 +228,64 @@ int main()
     SDL_RenderFillRect(window.getRenderer().get(), &rect);
   };
 
-  auto updatePlayerProjectile = [&](gamelib::Entity &entity, float deltaTime)
-  {
-    entity.applyVelocity(deltaTime);
-  };
-
-  auto renderPlayerProjectile = [&](gamelib::Entity &entity)
+  auto renderPlayerProjectile = [&](gamelib::BulletPool &pool, std::size_t index)
   {
     SDL_Rect rect = {
-        static_cast<int>(entity.getWorldPositionX() - (PLAYER_PROJECTILE_WIDTH * 0.5)),
-        static_cast<int>(entity.getWorldPositionY() - (PLAYER_PROJECTILE_HEIGHT * 0.5)),
+        static_cast<int>(pool.getPositionX(index) - (PLAYER_PROJECTILE_WIDTH * 0.5)),
+        static_cast<int>(pool.getPositionY(index) - (PLAYER_PROJECTILE_HEIGHT * 0.5)),
         PLAYER_PROJECTILE_WIDTH,
         PLAYER_PROJECTILE_HEIGHT};
     SDL_SetRenderDrawColor(window.getRenderer().get(), 0, 255, 255, 255);
     SDL_RenderFillRect(window.getRenderer().get(), &rect);
   };
 
-  auto updateEnemy = [&](gamelib::Entity &entity, float deltaTime)
+  auto renderEnemyProjectile = [&](gamelib::BulletPool &pool, std::size_t index)
   {
-    entity.applyVelocity(deltaTime);
-    if (entity.getWorldPositionX() < 0 || entity.getWorldPositionX() > WIDTH)
+    SDL_Rect rect = {
+        static_cast<int>(pool.getPositionX(index) - (ENEMY_PROJECTILE_SIZE * 0.5)),
+        static_cast<int>(pool.getPositionY(index) - (ENEMY_PROJECTILE_SIZE * 0.5)),
+        ENEMY_PROJECTILE_SIZE,
+        ENEMY_PROJECTILE_SIZE};
+    SDL_SetRenderDrawColor(window.getRenderer().get(), 255, 0, 255, 255);
+    SDL_RenderFillRect(window.getRenderer().get(), &rect);
+  };
+
+  auto applyVelocity = [&](gamelib::Position &position, const gamelib::Velocity &velocity, float deltaTime)
+  {
+    gamelib::StateScalar step = gamelib::toState(deltaTime);
+    position.x += velocity.x * step;
+    position.y += velocity.y * step;
+  };
+
+  auto updateEnemy = [&](gamelib::Position &position, gamelib::Velocity &velocity, float deltaTime)
+  {
+    applyVelocity(position, velocity, deltaTime);
+    if (position.x < gamelib::toState(0) || position.x > gamelib::toState(WIDTH))
     {
-      entity.setVelocityX(entity.getVelocityX() * -1);
-      entity.applyVelocity(deltaTime);
+      velocity.x = -velocity.x;
+      applyVelocity(position, velocity, deltaTime);
     }
-    if (entity.getWorldPositionY() < 0 || entity.getWorldPositionY() > HEIGHT)
+    if (position.y < gamelib::toState(0) || position.y > gamelib::toState(HEIGHT))
     {
-      entity.setVelocityY(entity.getVelocityY() * -1);
-      entity.applyVelocity(deltaTime);
+      velocity.y = -velocity.y;
+      applyVelocity(position, velocity, deltaTime);
     }
   };
 
-  auto renderEnemy = [&](gamelib::Entity &entity)
+  auto updateEnemyWeapon = [&](const gamelib::Position &position, gamelib::Weapon &weapon, float deltaTime)
+  {
+    // turn toward the player, then let the emitter fire whenever its interval is up
+    double weaponX = gamelib::fromState(position.x);
+    double weaponY = gamelib::fromState(position.y);
+    weapon.emitter.setDirection(player.getWorldPositionX() - weaponX, player.getWorldPositionY() - weaponY);
+    weapon.emitter.update(enemyProjectiles, weaponX, weaponY, deltaTime);
+  };
+
+  auto renderEnemy = [&](const gamelib::Position &position)
   {
     SDL_Rect rect = {
-        static_cast<int>(entity.getWorldPositionX() - (ENEMY_WIDTH * 0.5)),
-        static_cast<int>(entity.getWorldPositionY() - (ENEMY_HEIGHT * 0.5)),
+        static_cast<int>(gamelib::fromState(position.x) - (ENEMY_WIDTH * 0.5)),
+        static_cast<int>(gamelib::fromState(position.y) - (ENEMY_HEIGHT * 0.5)),
         ENEMY_WIDTH,
         ENEMY_HEIGHT,
     };
@@ -228,97 +293,216 @@ int main()
     SDL_RenderFillRect(window.getRenderer().get(), &rect);
   };
 
-  auto isOffScreen = [&](std::unique_ptr<gamelib::Entity> &entity)
-  {
-    gamelib::Entity &entityRef = *(entity.get());
-    auto x = entityRef.getWorldPositionX();
-    auto y = entityRef.getWorldPositionY();
-    return x < 0 || x > WIDTH || y < 0 || y > HEIGHT;
-  };
+  // the state of the level as it starts, restored when restarting
+  gamelib::Snapshot levelStart;
+  levelStart.save(player);
+  levelStart.save(world);
+  levelStart.save(projectiles);
+  levelStart.save(enemyProjectiles);
+  levelStart.save(playerWeapon);
+  levelStart.save(window.getRandom());
 
-  auto isDead = [&](std::unique_ptr<gamelib::Entity> &entity)
-  {
-    gamelib::Entity &entityRef = *(entity.get());
-    return entityRef.hasTag("DEAD");
-  };
+  bool isCaptureKeyDown = false;
+  bool isRestartKeyDown = false;
 
   while (window.isOpen())
   {
+    gamelib::AllocationTracker::beginFrame();
+
+    gamelib::AllocationTracker::beginPhase("events");
     window.processEvents();
+    gamelib::AllocationTracker::endPhase();
 
     float deltaTime = window.resetClock();
 
     // update here
 
+    gamelib::AllocationTracker::beginPhase("update");
+
     if (window.isKeyPressed("quit"))
     {
       window.close();
     }
 
-    updatePlayer(player, deltaTime);
+    // F12 starts and stops recording the screen to capture_NNNNNN.png
+    if (window.isKeyPressed("capture") && !isCaptureKeyDown)
+    {
+      isCaptureKeyDown = true;
+      if (window.getFrameCapture().isCapturing())
+      {
+        window.stopCapture();
+        window.getFrameCapture().report(std::cout);
+      }
+      else
+      {
+        window.startCapture("capture", gamelib::CaptureFormat::Png);
+      }
+    }
+    else if (!window.isKeyPressed("capture"))
+    {
+      isCaptureKeyDown = false;
+    }
 
-    for (auto &entity : projectiles)
+    // R restarts the level once per press, holding it does not keep resetting the level
+    if (window.isKeyPressed("restart") && !isRestartKeyDown)
+    {
+      isRestartKeyDown = true;
+      levelStart.rewind();
+      levelStart.restore(player);
+      levelStart.restore(world);
+      gamelib::resolveWeaponPatterns(world, weaponPatterns.data(), weaponPatterns.size());
+      levelStart.restore(projectiles);
+      levelStart.restore(enemyProjectiles);
+      levelStart.restore(playerWeapon);
+      levelStart.restore(window.getRandom());
+      particles.clear();
+      firingTime = 0.0f;
+    }
+    else if (!window.isKeyPressed("restart"))
     {
-      gamelib::Entity &projectileEntity = *(entity.get());
+      isRestartKeyDown = false;
+    }
 
-      updatePlayerProjectile(projectileEntity, deltaTime);
+    updatePlayer(player, deltaTime);
 
-      SDL_Rect projectileRect = {
-          static_cast<int>(projectileEntity.getWorldPositionX() - (PLAYER_PROJECTILE_WIDTH * 0.5)),
-          static_cast<int>(projectileEntity.getWorldPositionY() - (PLAYER_PROJECTILE_WIDTH * 0.5)),
-          PLAYER_PROJECTILE_WIDTH,
-          PLAYER_PROJECTILE_HEIGHT};
+    projectiles.applyVelocity(deltaTime);
+    enemyProjectiles.applyVelocity(deltaTime);
 
-      SDL_Rect intersectionRect;
+    gamelib::AllocationTracker::beginPhase("collision");
 
-      for (auto &entityB : enemies)
-      {
-        gamelib::Entity &enemyEntity = *(entityB.get());
-        SDL_Rect enemyRect = {
-            static_cast<int>(enemyEntity.getWorldPositionX() - (ENEMY_WIDTH * 0.5)),
-            static_cast<int>(enemyEntity.getWorldPositionY() - (ENEMY_WIDTH * 0.5)),
-            ENEMY_WIDTH,
-            ENEMY_HEIGHT};
-
-        if (SDL_IntersectRect(&projectileRect, &enemyRect, &intersectionRect))
+    // pack the enemy boxes once per frame so every projectile is tested against all of them at once
+    enemyBoxes.clear();
+    enemyHandles.clear();
+    world.each<gamelib::Position, gamelib::Enemy>(
+        [&](gamelib::EntityHandle enemy, gamelib::Position &enemyPosition, gamelib::Enemy &)
         {
-          // mark the enemy to be erased (or maybe reduce its health/shield percentage..)
-          enemyEntity.setTag("DEAD");
+          enemyBoxes.add({
+              static_cast<float>(gamelib::fromState(enemyPosition.x) - (ENEMY_WIDTH * 0.5)),
+              static_cast<float>(gamelib::fromState(enemyPosition.y) - (ENEMY_HEIGHT * 0.5)),
+              static_cast<float>(gamelib::fromState(enemyPosition.x) + (ENEMY_WIDTH * 0.5)),
+              static_cast<float>(gamelib::fromState(enemyPosition.y) + (ENEMY_HEIGHT * 0.5))});
+          enemyHandles.push_back(enemy);
+        });
+    enemyHits.resize(enemyBoxes.paddedSize());
+    isEnemyQueued.assign(enemyBoxes.size(), 0);
+
+    for (std::size_t projectileIndex = 0; projectileIndex < projectiles.size(); ++projectileIndex)
+    {
+      double projectileX = projectiles.getPositionX(projectileIndex);
+      double projectileY = projectiles.getPositionY(projectileIndex);
+      gamelib::Aabb projectileBox = {
+          static_cast<float>(projectileX - (PLAYER_PROJECTILE_WIDTH * 0.5)),
+          static_cast<float>(projectileY - (PLAYER_PROJECTILE_HEIGHT * 0.5)),
+          static_cast<float>(projectileX + (PLAYER_PROJECTILE_WIDTH * 0.5)),
+          static_cast<float>(projectileY + (PLAYER_PROJECTILE_HEIGHT * 0.5))};
+
+      std::size_t hitCount = gamelib::overlapOneToMany(projectileBox, enemyBoxes, enemyHits.data(), enemyHits.size());
+      for (std::size_t hit = 0; hit < hitCount; ++hit)
+      {
+        std::uint32_t enemyIndex = enemyHits[hit];
 
-          // erase the projectile (move the projectile way off screen and it will be deleted)
-          projectileEntity.setWorldPositionX(-9999);
+        // mark the enemy to be erased (or maybe reduce its health/shield percentage..)
+        if (!isEnemyQueued[enemyIndex])
+        {
+          isEnemyQueued[enemyIndex] = 1;
+          deadEnemies.push_back(enemyHandles[enemyIndex]);
         }
+
+        float enemyX = enemyBoxes.getMinX()[enemyIndex] + static_cast<float>(ENEMY_WIDTH * 0.5);
+        float enemyY = enemyBoxes.getMinY()[enemyIndex] + static_cast<float>(ENEMY_HEIGHT * 0.5);
+        particles.emit(explosionEmitter, enemyX, enemyY);
+        particles.emit(sparkEmitter, projectileX, projectileY);
+
+        // erase the projectile (move the projectile way off screen and it will be deleted)
+        projectiles.setPositionX(projectileIndex, -9999);
       }
     }
 
     // remove dead enemies
-    enemies.erase(std::remove_if(enemies.begin(), enemies.end(), isDead), enemies.end());
+    for (auto enemy : deadEnemies)
+    {
+      world.destroy(enemy);
+    }
+    deadEnemies.clear();
+
+    // enemy projectiles only ever hit the player
+    gamelib::Aabb playerBox = {
+        static_cast<float>(player.getWorldPositionX() - (PLAYER_WIDTH * 0.5)),
+        static_cast<float>(player.getWorldPositionY() - (PLAYER_HEIGHT * 0.5)),
+        static_cast<float>(player.getWorldPositionX() + (PLAYER_WIDTH * 0.5)),
+        static_cast<float>(player.getWorldPositionY() + (PLAYER_HEIGHT * 0.5))};
+    for (std::size_t projectileIndex = 0; projectileIndex < enemyProjectiles.size(); ++projectileIndex)
+    {
+      float projectileX = static_cast<float>(enemyProjectiles.getPositionX(projectileIndex));
+      float projectileY = static_cast<float>(enemyProjectiles.getPositionY(projectileIndex));
+      if (projectileX > playerBox.minX && projectileX < playerBox.maxX &&
+          projectileY > playerBox.minY && projectileY < playerBox.maxY)
+      {
+        particles.emit(sparkEmitter, projectileX, projectileY);
+        enemyProjectiles.setPositionX(projectileIndex, -9999);
+      }
+    }
 
     // remove projectiles that are off screen
-    projectiles.erase(std::remove_if(projectiles.begin(), projectiles.end(), isOffScreen), projectiles.end());
+    projectiles.removeOutside(0, 0, WIDTH, HEIGHT);
+    enemyProjectiles.removeOutside(0, 0, WIDTH, HEIGHT);
 
-    for (auto &entity : enemies)
-    {
-      updateEnemy(*(entity.get()), deltaTime);
-    }
+    gamelib::AllocationTracker::endPhase();
+
+    world.each<gamelib::Position, gamelib::Velocity, gamelib::Enemy>(
+        [&](gamelib::EntityHandle, gamelib::Position &position, gamelib::Velocity &velocity, gamelib::Enemy &)
+        {
+          updateEnemy(position, velocity, deltaTime);
+        });
+
+    world.each<gamelib::Position, gamelib::Weapon>(
+        [&](gamelib::EntityHandle, gamelib::Position &position, gamelib::Weapon &weapon)
+        {
+          updateEnemyWeapon(position, weapon, deltaTime);
+        });
+
+    particles.update(deltaTime);
+
+    gamelib::AllocationTracker::endPhase();
+
+    gamelib::AllocationTracker::beginPhase("render");
 
     window.prepareRender();
 
     // draw here
 
-    for (auto &entity : enemies)
+    world.each<gamelib::Position, gamelib::Enemy>(
+        [&](gamelib::EntityHandle, gamelib::Position &position, gamelib::Enemy &)
+        {
+          renderEnemy(position);
+        });
+
+    particles.render(window.getRenderer().get());
+
+    for (std::size_t projectileIndex = 0; projectileIndex < projectiles.size(); ++projectileIndex)
     {
-      renderEnemy(*(entity.get()));
+      renderPlayerProjectile(projectiles, projectileIndex);
     }
 
-    for (auto &entity : projectiles)
+    for (std::size_t projectileIndex = 0; projectileIndex < enemyProjectiles.size(); ++projectileIndex)
     {
-      renderPlayerProjectile(*(entity.get()));
+      renderEnemyProjectile(enemyProjectiles, projectileIndex);
     }
 
     renderPlayer(player);
 
     window.presentRender();
+
+    gamelib::AllocationTracker::endPhase();
+
+    gamelib::AllocationTracker::endFrame();
+  }
+
+  window.getFramePacer().report(std::cout);
+
+  if (gamelib::AllocationTracker::isEnabled())
+  {
+    gamelib::AllocationTracker::report(std::cout);
   }
 
   return 0;
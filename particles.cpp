@@ -0,0 +1,214 @@
+#include "particles.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+// creates an empty system able to hold up to maxParticles particles
+ParticleSystem::ParticleSystem(std::size_t maxParticles) : capacity(maxParticles),
+                                                           used(0),
+                                                           cursor(0),
+                                                           positionX(maxParticles),
+                                                           positionY(maxParticles),
+                                                           velocityX(maxParticles),
+                                                           velocityY(maxParticles),
+                                                           lifetime(maxParticles, 0.0f),
+                                                           inverseMaxLifetime(maxParticles, 0.0f),
+                                                           extent(maxParticles),
+                                                           red(maxParticles),
+                                                           green(maxParticles),
+                                                           blue(maxParticles),
+                                                           owner(maxParticles),
+                                                           emitterEffects(),
+                                                           emitterBudgets(),
+                                                           emitterLiveCounts(),
+                                                           directionX(DIRECTION_TABLE_SIZE),
+                                                           directionY(DIRECTION_TABLE_SIZE),
+                                                           vertices(maxParticles * 4),
+                                                           indices(maxParticles * 6),
+                                                           drag(0.0f),
+                                                           rng()
+{
+  // random directions are picked from a table so that spawning does no trigonometry
+  for (std::size_t i = 0; i < DIRECTION_TABLE_SIZE; ++i)
+  {
+    double angle = (2.0 * M_PI * i) / DIRECTION_TABLE_SIZE;
+    directionX[i] = static_cast<float>(cos(angle));
+    directionY[i] = static_cast<float>(sin(angle));
+  }
+
+  // every particle is a quad made of two triangles, the index pattern never changes
+  for (std::size_t i = 0; i < maxParticles; ++i)
+  {
+    int corner = static_cast<int>(i * 4);
+    int *quad = &indices[i * 6];
+    quad[0] = corner;
+    quad[1] = corner + 1;
+    quad[2] = corner + 2;
+    quad[3] = corner + 2;
+    quad[4] = corner + 3;
+    quad[5] = corner;
+  }
+}
+
+// registers an effect which may have at most budget particles alive at once.
+int ParticleSystem::createEmitter(const ParticleEffect &effect, std::size_t budget)
+{
+  if (emitterEffects.size() >= UINT16_MAX)
+  {
+    // every particle stores its emitter id in 16 bits
+    throw std::runtime_error("Unable to create particle emitter: the limit of " + std::to_string(UINT16_MAX) + " emitters has been reached");
+  }
+  emitterEffects.push_back(effect);
+  emitterBudgets.push_back(budget);
+  emitterLiveCounts.push_back(0);
+  return static_cast<int>(emitterEffects.size() - 1);
+}
+
+// spawns one burst of the emitter's effect at the given world position.
+std::size_t ParticleSystem::emit(int emitterId, float x, float y)
+{
+  if (emitterId < 0 || static_cast<std::size_t>(emitterId) >= emitterEffects.size())
+  {
+    throw std::runtime_error("Unable to emit particles: there is no emitter with id " + std::to_string(emitterId));
+  }
+  const ParticleEffect &effect = emitterEffects[emitterId];
+  std::size_t &liveCount = emitterLiveCounts[emitterId];
+
+  std::size_t available = emitterBudgets[emitterId] - std::min(emitterBudgets[emitterId], liveCount);
+  std::size_t n = std::min({static_cast<std::size_t>(std::max(effect.count, 0)), available, capacity});
+
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    std::size_t i = cursor;
+    cursor = (cursor + 1) % capacity;
+    used = std::max(used, i + 1);
+
+    // the slot may still hold a live particle, in which case it is recycled
+    if (lifetime[i] > 0.0f)
+    {
+      --emitterLiveCounts[owner[i]];
+    }
+
+    std::size_t direction = rng.next() % DIRECTION_TABLE_SIZE;
+    float speed = rng.nextFloat(effect.minSpeed, effect.maxSpeed);
+    float life = rng.nextFloat(effect.minLifetime, effect.maxLifetime);
+    if (!(life > 0.0f))
+    {
+      // a particle counts against the budget until update() sees it expire, which it only
+      // does for particles which were alive, so every particle lives for at least one update
+      life = std::numeric_limits<float>::min();
+    }
+
+    positionX[i] = x;
+    positionY[i] = y;
+    velocityX[i] = directionX[direction] * speed;
+    velocityY[i] = directionY[direction] * speed;
+    lifetime[i] = life;
+    inverseMaxLifetime[i] = 1.0f / life;
+    extent[i] = effect.size;
+    red[i] = effect.red;
+    green[i] = effect.green;
+    blue[i] = effect.blue;
+    owner[i] = static_cast<std::uint16_t>(emitterId);
+  }
+
+  liveCount += n;
+  return n;
+}
+
+// moves, slows and ages every particle
+void ParticleSystem::update(float deltaTime)
+{
+  float damping = std::max(0.0f, 1.0f - drag * deltaTime);
+
+  // integrate every slot without checking for life so the loop stays branch free
+  float *x = positionX.data();
+  float *y = positionY.data();
+  float *vx = velocityX.data();
+  float *vy = velocityY.data();
+  for (std::size_t i = 0; i < used; ++i)
+  {
+    x[i] += vx[i] * deltaTime;
+    y[i] += vy[i] * deltaTime;
+    vx[i] *= damping;
+    vy[i] *= damping;
+  }
+
+  // age particles and hand the slots of the ones which just expired back to their emitter budget
+  float *life = lifetime.data();
+  for (std::size_t i = 0; i < used; ++i)
+  {
+    float before = life[i];
+    float after = before - deltaTime;
+    life[i] = after;
+    if (before > 0.0f && after <= 0.0f)
+    {
+      --emitterLiveCounts[owner[i]];
+    }
+  }
+}
+
+// draws every live particle in a single batch
+void ParticleSystem::render(SDL_Renderer *renderer)
+{
+  int quadCount = 0;
+  for (std::size_t i = 0; i < used; ++i)
+  {
+    if (lifetime[i] <= 0.0f)
+    {
+      continue;
+    }
+
+    // fade out linearly over the lifetime of the particle
+    float fade = std::min(lifetime[i] * inverseMaxLifetime[i], 1.0f);
+    SDL_Color color = {red[i], green[i], blue[i], static_cast<Uint8>(fade * 255.0f)};
+
+    float half = extent[i] * 0.5f;
+    float left = positionX[i] - half;
+    float top = positionY[i] - half;
+    float right = positionX[i] + half;
+    float bottom = positionY[i] + half;
+
+    SDL_Vertex *quad = &vertices[quadCount * 4];
+    quad[0] = {{left, top}, color, {0.0f, 0.0f}};
+    quad[1] = {{right, top}, color, {0.0f, 0.0f}};
+    quad[2] = {{right, bottom}, color, {0.0f, 0.0f}};
+    quad[3] = {{left, bottom}, color, {0.0f, 0.0f}};
+    ++quadCount;
+  }
+
+  if (quadCount == 0)
+  {
+    return;
+  }
+
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+  SDL_RenderGeometry(renderer, nullptr, vertices.data(), quadCount * 4, indices.data(), quadCount * 6);
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
+
+// removes every particle
+void ParticleSystem::clear()
+{
+  std::fill(lifetime.begin(), lifetime.end(), 0.0f);
+  std::fill(emitterLiveCounts.begin(), emitterLiveCounts.end(), 0);
+  used = 0;
+  cursor = 0;
+}
+
+// number of live particles
+std::size_t ParticleSystem::size() const
+{
+  std::size_t total = 0;
+  for (auto liveCount : emitterLiveCounts)
+  {
+    total += liveCount;
+  }
+  return total;
+}
@@ -0,0 +1,129 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "random.h"
+
+namespace gamelib
+{
+
+  /*
+
+  ParticleEffect
+    - describes what a single burst of particles looks like
+    - every particle in the burst gets a random direction, a random speed between
+      minSpeed and maxSpeed and a random lifetime between minLifetime and maxLifetime
+    - particles are square, size pixels wide, and fade out over their lifetime
+    - a lifetime which is not positive is treated as the shortest possible one, the
+      particle expires on the next update
+
+  */
+
+  // PARTICLE EFFECT STRUCT
+  struct ParticleEffect
+  {
+    int count;
+    float minSpeed;
+    float maxSpeed;
+    float minLifetime;
+    float maxLifetime;
+    float size;
+    Uint8 red;
+    Uint8 green;
+    Uint8 blue;
+  };
+
+  /*
+
+  ParticleSystem
+    - every visual effect particle lives in a ParticleSystem instead of being an Entity
+    - the system has a fixed capacity; all storage, including the vertex buffers used for
+      drawing, is allocated once when it is constructed
+    - particle state is stored as parallel arrays (structure of arrays)
+    - new particles are written into slots in ring order, so when the system is full the
+      oldest particles are recycled first
+    - particles are updated as a whole without branching on whether they are alive,
+      dead particles simply stay invisible until their slot is reused
+    - all live particles are drawn with one call to SDL_RenderGeometry
+    - each emitter created in the system has a budget: the most particles it may have alive
+      at once, so that one busy effect cannot starve the others
+
+  */
+
+  // PARTICLE SYSTEM CLASS
+  class ParticleSystem
+  {
+  protected:
+    // number of entries in the precomputed table of unit directions
+    static constexpr std::size_t DIRECTION_TABLE_SIZE = 256;
+
+    std::size_t capacity;
+    std::size_t used;
+    std::size_t cursor;
+
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> lifetime;
+    std::vector<float> inverseMaxLifetime;
+    std::vector<float> extent;
+    std::vector<Uint8> red;
+    std::vector<Uint8> green;
+    std::vector<Uint8> blue;
+    std::vector<std::uint16_t> owner;
+
+    std::vector<ParticleEffect> emitterEffects;
+    std::vector<std::size_t> emitterBudgets;
+    std::vector<std::size_t> emitterLiveCounts;
+
+    std::vector<float> directionX;
+    std::vector<float> directionY;
+
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    float drag;
+    Random rng;
+
+  public:
+    // creates an empty system able to hold up to maxParticles particles
+    explicit ParticleSystem(std::size_t maxParticles);
+
+    // registers an effect which may have at most budget particles alive at once.
+    // returns the id of the new emitter, throws once UINT16_MAX emitters exist
+    int createEmitter(const ParticleEffect &effect, std::size_t budget);
+
+    // spawns one burst of the emitter's effect at the given world position.
+    // returns the number of particles spawned (fewer than the effect count when over budget),
+    // throws when there is no emitter with that id
+    std::size_t emit(int emitterId, float x, float y);
+
+    // fraction of velocity lost per second, zero means particles never slow down
+    void setDrag(float dragPerSecond) { drag = dragPerSecond; }
+
+    // moves, slows and ages every particle
+    void update(float deltaTime);
+
+    // draws every live particle in a single batch
+    void render(SDL_Renderer *renderer);
+
+    // removes every particle
+    void clear();
+
+    // number of live particles
+    std::size_t size() const;
+
+    // maximum number of live particles
+    std::size_t getCapacity() const { return capacity; }
+
+    // number of live particles owned by an emitter
+    std::size_t getLiveCount(int emitterId) const { return emitterLiveCounts[emitterId]; }
+  };
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "particles.h"
+#include "testing.h"
+
+#include <cstdint>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // count, min speed, max speed, min lifetime, max lifetime, size, red, green, blue
+  const ParticleEffect BURST = {100, 10.0f, 20.0f, 0.5f, 1.0f, 2.0f, 255, 255, 255};
+
+  // an emitter never has more particles alive than its budget
+  void testBudgetCapsLiveParticles()
+  {
+    ParticleSystem particles(1000);
+    int emitter = particles.createEmitter(BURST, 30);
+
+    CHECK(particles.emit(emitter, 0.0f, 0.0f) == 30);
+    CHECK(particles.getLiveCount(emitter) == 30);
+    CHECK(particles.emit(emitter, 0.0f, 0.0f) == 0);
+    CHECK(particles.size() == 30);
+  }
+
+  // expired particles hand their slots back to the budget
+  void testExpiredParticlesReturnToBudget()
+  {
+    ParticleSystem particles(1000);
+    int emitter = particles.createEmitter(BURST, 30);
+
+    particles.emit(emitter, 0.0f, 0.0f);
+    particles.update(2.0f);
+    CHECK(particles.getLiveCount(emitter) == 0);
+    CHECK(particles.emit(emitter, 0.0f, 0.0f) == 30);
+  }
+
+  // particles without a positive lifetime still expire, so they never leak budget
+  void testZeroLifetimeDoesNotLeakBudget()
+  {
+    ParticleSystem particles(1000);
+    ParticleEffect instant = BURST;
+    instant.minLifetime = 0.0f;
+    instant.maxLifetime = 0.0f;
+    int emitter = particles.createEmitter(instant, 30);
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+      CHECK(particles.emit(emitter, 0.0f, 0.0f) == 30);
+      particles.update(1.0f / 60.0f);
+      CHECK(particles.getLiveCount(emitter) == 0);
+    }
+  }
+
+  // one busy emitter cannot use the budget of another
+  void testEmittersHaveSeparateBudgets()
+  {
+    ParticleSystem particles(1000);
+    int busy = particles.createEmitter(BURST, 50);
+    int quiet = particles.createEmitter(BURST, 10);
+
+    particles.emit(busy, 0.0f, 0.0f);
+    particles.emit(busy, 0.0f, 0.0f);
+    CHECK(particles.emit(quiet, 0.0f, 0.0f) == 10);
+    CHECK(particles.getLiveCount(busy) == 50);
+    CHECK(particles.getLiveCount(quiet) == 10);
+  }
+
+  // when the system is full the oldest particles are recycled and counted off their emitter
+  void testRecyclingKeepsCountsInCapacity()
+  {
+    ParticleSystem particles(64);
+    int first = particles.createEmitter(BURST, 1000);
+    int second = particles.createEmitter(BURST, 1000);
+
+    CHECK(particles.emit(first, 0.0f, 0.0f) == 64);
+    CHECK(particles.emit(second, 0.0f, 0.0f) == 64);
+    CHECK(particles.getLiveCount(first) == 0);
+    CHECK(particles.getLiveCount(second) == 64);
+    CHECK(particles.size() == particles.getCapacity());
+  }
+
+  // clear() empties the system and every budget
+  void testClearResetsBudgets()
+  {
+    ParticleSystem particles(1000);
+    int emitter = particles.createEmitter(BURST, 30);
+
+    particles.emit(emitter, 0.0f, 0.0f);
+    particles.clear();
+    CHECK(particles.size() == 0);
+    CHECK(particles.emit(emitter, 0.0f, 0.0f) == 30);
+  }
+
+  // ids which createEmitter() never handed out are rejected
+  void testUnknownEmitterIdThrows()
+  {
+    ParticleSystem particles(16);
+    int emitter = particles.createEmitter(BURST, 8);
+
+    CHECK_THROWS(particles.emit(-1, 0.0f, 0.0f));
+    CHECK_THROWS(particles.emit(emitter + 1, 0.0f, 0.0f));
+  }
+
+  // emitter ids are stored in 16 bits, so the 65536th emitter is refused
+  void testEmitterLimitThrows()
+  {
+    ParticleSystem particles(16);
+    for (std::uint32_t i = 0; i < UINT16_MAX; ++i)
+    {
+      particles.createEmitter(BURST, 1);
+    }
+    CHECK_THROWS(particles.createEmitter(BURST, 1));
+  }
+}
+
+int main()
+{
+  testBudgetCapsLiveParticles();
+  testExpiredParticlesReturnToBudget();
+  testZeroLifetimeDoesNotLeakBudget();
+  testEmittersHaveSeparateBudgets();
+  testRecyclingKeepsCountsInCapacity();
+  testClearResetsBudgets();
+  testUnknownEmitterIdThrows();
+  testEmitterLimitThrows();
+  return finishTests("particles");
+}
@@ -0,0 +1,245 @@
+#include "random.h"
+
+#include <atomic>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // seed shared by every thread generator, each thread picks a different stream
+  std::atomic<std::uint64_t> threadSeed(0);
+
+  // stream 0 is left for generators which are seeded by hand
+  std::atomic<std::uint64_t> nextThreadStream(1);
+
+  // scale which maps a 31 bit number onto [0, 1)
+  constexpr double INVERSE_2_POW_31 = 1.0 / 2147483648.0;
+
+  // scale which maps a 32 bit number onto [0, 1)
+  constexpr double INVERSE_2_POW_32 = 1.0 / 4294967296.0;
+
+  inline std::uint32_t rotateLeft(std::uint32_t value, int bits)
+  {
+    return (value << bits) | (value >> (32 - bits));
+  }
+}
+
+// default constructor - seed 0, stream 0
+Random::Random()
+{
+  seed(0, 0);
+}
+
+// specialized constructor - generator seeded with the given seed and stream
+Random::Random(std::uint64_t seedValue, std::uint64_t stream)
+{
+  seed(seedValue, stream);
+}
+
+// restarts the generator from the given seed and stream
+void Random::seed(std::uint64_t seedValue, std::uint64_t stream)
+{
+  // the standard PCG32 seeding sequence
+  state = 0;
+  increment = (stream << 1u) | 1u;
+  next();
+  state += seedValue;
+  next();
+
+  // the bulk lanes are seeded from this generator so they follow the same seed and stream
+  for (std::size_t lane = 0; lane < LANES; ++lane)
+  {
+    for (std::size_t word = 0; word < 4; ++word)
+    {
+      laneState[word][lane] = next();
+    }
+    // xoshiro must never have an all zero state
+    if ((laneState[0][lane] | laneState[1][lane] | laneState[2][lane] | laneState[3][lane]) == 0)
+    {
+      laneState[0][lane] = 1;
+    }
+  }
+}
+
+// returns a uniformly distributed 32 bit number
+std::uint32_t Random::next()
+{
+  std::uint64_t previous = state;
+  state = previous * 6364136223846793005ULL + increment;
+  std::uint32_t xorShifted = static_cast<std::uint32_t>(((previous >> 18u) ^ previous) >> 27u);
+  std::uint32_t rotation = static_cast<std::uint32_t>(previous >> 59u);
+  return (xorShifted >> rotation) | (xorShifted << ((32u - rotation) & 31u));
+}
+
+// returns a number in the range [lowInclusive, highInclusive]
+int Random::nextInt(int lowInclusive, int highInclusive)
+{
+  std::uint64_t range = static_cast<std::uint64_t>(static_cast<std::int64_t>(highInclusive) - lowInclusive + 1);
+  std::uint64_t offset = (static_cast<std::uint64_t>(next()) * range) >> 32u;
+  return static_cast<int>(lowInclusive + static_cast<std::int64_t>(offset));
+}
+
+// returns a number in the range [lowInclusive, highExclusive)
+double Random::nextDouble(double lowInclusive, double highExclusive)
+{
+  return lowInclusive + (highExclusive - lowInclusive) * (next() * INVERSE_2_POW_32);
+}
+
+// returns a number in the range [lowInclusive, highExclusive)
+float Random::nextFloat(float lowInclusive, float highExclusive)
+{
+  // only 24 bits fit in the mantissa of a float
+  return lowInclusive + (highExclusive - lowInclusive) * (static_cast<float>(next() >> 8u) * (1.0f / 16777216.0f));
+}
+
+// steps the bulk lanes once, writing one number per lane to out
+void Random::nextLanes(std::uint32_t *out)
+{
+  for (std::size_t lane = 0; lane < LANES; ++lane)
+  {
+    // xoshiro128+
+    std::uint32_t *s0 = &laneState[0][lane];
+    std::uint32_t *s1 = &laneState[1][lane];
+    std::uint32_t *s2 = &laneState[2][lane];
+    std::uint32_t *s3 = &laneState[3][lane];
+
+    out[lane] = *s0 + *s3;
+
+    std::uint32_t t = *s1 << 9;
+    *s2 ^= *s0;
+    *s3 ^= *s1;
+    *s1 ^= *s2;
+    *s0 ^= *s3;
+    *s2 ^= t;
+    *s3 = rotateLeft(*s3, 11);
+  }
+}
+
+// fills out with count numbers in the range [lowInclusive, highInclusive]
+void Random::fillInt(int *out, std::size_t count, int lowInclusive, int highInclusive)
+{
+  std::uint64_t range = static_cast<std::uint64_t>(static_cast<std::int64_t>(highInclusive) - lowInclusive + 1);
+  std::size_t i = 0;
+
+#if defined(__SSE2__)
+  // the vector path needs the range to fit in 32 bits, which is every range except the full int range
+  if (range <= 0xFFFFFFFFull)
+  {
+    __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(laneState[0]));
+    __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(laneState[1]));
+    __m128i s2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(laneState[2]));
+    __m128i s3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(laneState[3]));
+    __m128i vectorRange = _mm_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(range)));
+    __m128i vectorLow = _mm_set1_epi32(lowInclusive);
+    __m128i highHalves = _mm_set_epi32(-1, 0, -1, 0);
+
+    for (; i + LANES <= count; i += LANES)
+    {
+      __m128i result = _mm_add_epi32(s0, s3);
+
+      __m128i t = _mm_slli_epi32(s1, 9);
+      s2 = _mm_xor_si128(s2, s0);
+      s3 = _mm_xor_si128(s3, s1);
+      s1 = _mm_xor_si128(s1, s2);
+      s0 = _mm_xor_si128(s0, s3);
+      s2 = _mm_xor_si128(s2, t);
+      s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+      // (result * range) >> 32 for each lane; SSE2 only multiplies the even lanes so do it twice
+      __m128i evenProducts = _mm_mul_epu32(result, vectorRange);
+      __m128i oddProducts = _mm_mul_epu32(_mm_srli_epi64(result, 32), vectorRange);
+      __m128i offsets = _mm_or_si128(_mm_srli_epi64(evenProducts, 32), _mm_and_si128(oddProducts, highHalves));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_add_epi32(offsets, vectorLow));
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(laneState[0]), s0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(laneState[1]), s1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(laneState[2]), s2);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(laneState[3]), s3);
+  }
+#endif
+
+  // whatever is left (or everything, without SSE2) goes through the scalar lanes
+  std::uint32_t block[LANES];
+  while (i < count)
+  {
+    nextLanes(block);
+    for (std::size_t lane = 0; lane < LANES && i < count; ++lane, ++i)
+    {
+      std::uint64_t offset = (static_cast<std::uint64_t>(block[lane]) * range) >> 32u;
+      out[i] = static_cast<int>(lowInclusive + static_cast<std::int64_t>(offset));
+    }
+  }
+}
+
+// fills out with count numbers in the range [lowInclusive, highExclusive)
+void Random::fillDouble(double *out, std::size_t count, double lowInclusive, double highExclusive)
+{
+  double scale = (highExclusive - lowInclusive) * INVERSE_2_POW_31;
+  std::size_t i = 0;
+
+#if defined(__SSE2__)
+  __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(laneState[0]));
+  __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(laneState[1]));
+  __m128i s2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(laneState[2]));
+  __m128i s3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(laneState[3]));
+  __m128d vectorScale = _mm_set1_pd(scale);
+  __m128d vectorLow = _mm_set1_pd(lowInclusive);
+
+  for (; i + LANES <= count; i += LANES)
+  {
+    __m128i result = _mm_add_epi32(s0, s3);
+
+    __m128i t = _mm_slli_epi32(s1, 9);
+    s2 = _mm_xor_si128(s2, s0);
+    s3 = _mm_xor_si128(s3, s1);
+    s1 = _mm_xor_si128(s1, s2);
+    s0 = _mm_xor_si128(s0, s3);
+    s2 = _mm_xor_si128(s2, t);
+    s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+    // drop one bit so the numbers convert as positive signed integers
+    __m128i positive = _mm_srli_epi32(result, 1);
+    __m128d low = _mm_cvtepi32_pd(positive);
+    __m128d high = _mm_cvtepi32_pd(_mm_shuffle_epi32(positive, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    _mm_storeu_pd(out + i, _mm_add_pd(vectorLow, _mm_mul_pd(low, vectorScale)));
+    _mm_storeu_pd(out + i + 2, _mm_add_pd(vectorLow, _mm_mul_pd(high, vectorScale)));
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(laneState[0]), s0);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(laneState[1]), s1);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(laneState[2]), s2);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(laneState[3]), s3);
+#endif
+
+  // whatever is left (or everything, without SSE2) goes through the scalar lanes
+  std::uint32_t block[LANES];
+  while (i < count)
+  {
+    nextLanes(block);
+    for (std::size_t lane = 0; lane < LANES && i < count; ++lane, ++i)
+    {
+      out[i] = lowInclusive + static_cast<double>(block[lane] >> 1u) * scale;
+    }
+  }
+}
+
+// the generator which belongs to the calling thread, each thread gets its own stream
+Random &Random::forThisThread()
+{
+  thread_local Random generator(threadSeed.load(), nextThreadStream.fetch_add(1));
+  return generator;
+}
+
+// sets the seed used by generators of threads which have not called forThisThread() yet
+void Random::seedThreads(std::uint64_t seedValue)
+{
+  threadSeed.store(seedValue);
+}
@@ -0,0 +1,82 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gamelib
+{
+
+  /*
+
+  Random
+    - a small, fast pseudo random number generator (PCG32, 16 bytes of state for next() and
+      the functions built on it)
+    - every Random is seeded explicitly with a seed and a stream number; generators with the
+      same seed but different streams produce independent sequences
+    - worker threads must not share a generator, use Random::forThisThread() to get one which
+      belongs to the calling thread
+    - the fill functions generate whole arrays of ranged numbers at once using four extra
+      xoshiro128+ lanes, which are stepped together with SSE2 when it is available; the lanes
+      add another 64 bytes, so a whole Random is 80 bytes
+    - the lanes step once per LANES numbers, so filling a multiple of LANES numbers at a time
+      gives the same numbers however the fill is split up; the rest of a partial step is dropped
+    - ranged integers are mapped with a multiply and shift, which is very slightly biased for
+      ranges which are not a power of two; that is fine for games but not for cryptography
+
+  */
+
+  // RANDOM CLASS
+  class Random
+  {
+    friend class Snapshot;
+
+  public:
+    // number of lanes stepped together by the fill functions
+    static constexpr std::size_t LANES = 4;
+
+  protected:
+    std::uint64_t state;
+    std::uint64_t increment;
+    std::uint32_t laneState[4][LANES];
+
+    // steps the bulk lanes once, writing one number per lane to out
+    void nextLanes(std::uint32_t *out);
+
+  public:
+    // default constructor - seed 0, stream 0
+    Random();
+
+    // specialized constructor - generator seeded with the given seed and stream
+    Random(std::uint64_t seed, std::uint64_t stream = 0);
+
+    // restarts the generator from the given seed and stream
+    void seed(std::uint64_t seed, std::uint64_t stream = 0);
+
+    // returns a uniformly distributed 32 bit number
+    std::uint32_t next();
+
+    // returns a number in the range [lowInclusive, highInclusive]
+    int nextInt(int lowInclusive, int highInclusive);
+
+    // returns a number in the range [lowInclusive, highExclusive)
+    double nextDouble(double lowInclusive, double highExclusive);
+
+    // returns a number in the range [lowInclusive, highExclusive)
+    float nextFloat(float lowInclusive, float highExclusive);
+
+    // fills out with count numbers in the range [lowInclusive, highInclusive]
+    void fillInt(int *out, std::size_t count, int lowInclusive, int highInclusive);
+
+    // fills out with count numbers in the range [lowInclusive, highExclusive)
+    void fillDouble(double *out, std::size_t count, double lowInclusive, double highExclusive);
+
+    // the generator which belongs to the calling thread, each thread gets its own stream
+    static Random &forThisThread();
+
+    // sets the seed used by generators of threads which have not called forThisThread() yet
+    static void seedThreads(std::uint64_t seed);
+  };
+}
+
+#endif
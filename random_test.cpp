@@ -0,0 +1,153 @@
+#include "random.h"
+#include "testing.h"
+
+#include <algorithm>
+#include <climits>
+#include <thread>
+#include <vector>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // the same seed and stream always give the same numbers, another stream gives others
+  void testSeedAndStreamAreDeterministic()
+  {
+    Random first(1234, 7);
+    Random second(1234, 7);
+    Random otherStream(1234, 8);
+    bool allSame = true;
+    bool anyDifferent = false;
+    for (int i = 0; i < 1000; ++i)
+    {
+      std::uint32_t value = first.next();
+      allSame &= value == second.next();
+      anyDifferent |= value != otherStream.next();
+    }
+    CHECK(allSame);
+    CHECK(anyDifferent);
+
+    // reseeding starts the sequence over
+    first.seed(1234, 7);
+    second.seed(1234, 7);
+    CHECK(first.next() == second.next());
+  }
+
+  // whole LANES multiples give the same numbers however the fill is split up
+  void testFillIsIndependentOfChunking()
+  {
+    constexpr std::size_t COUNT = 256;
+    Random whole(99);
+    Random pieces(99);
+    std::vector<int> wholeInts(COUNT);
+    std::vector<int> pieceInts(COUNT);
+
+    whole.fillInt(wholeInts.data(), COUNT, -50, 50);
+    std::size_t offset = 0;
+    for (std::size_t chunk : {4, 8, 12, 36, 68, 128})
+    {
+      pieces.fillInt(pieceInts.data() + offset, chunk, -50, 50);
+      offset += chunk;
+    }
+    CHECK(offset == COUNT);
+    CHECK(wholeInts == pieceInts);
+
+    std::vector<double> wholeDoubles(COUNT);
+    std::vector<double> pieceDoubles(COUNT);
+    whole.fillDouble(wholeDoubles.data(), COUNT, 0.0, 1.0);
+    for (std::size_t i = 0; i < COUNT; i += Random::LANES)
+    {
+      pieces.fillDouble(pieceDoubles.data() + i, Random::LANES, 0.0, 1.0);
+    }
+    CHECK(wholeDoubles == pieceDoubles);
+  }
+
+  // a partial step (the scalar tail) gives the same numbers as the vector path, then drops the rest
+  void testPartialFillMatchesWholeFill()
+  {
+    Random vector(5);
+    Random scalar(5);
+    int vectorInts[Random::LANES * 2];
+    int scalarInts[Random::LANES * 2];
+
+    vector.fillInt(vectorInts, Random::LANES, 0, 1000);
+    scalar.fillInt(scalarInts, Random::LANES - 1, 0, 1000);
+    CHECK(std::equal(scalarInts, scalarInts + Random::LANES - 1, vectorInts));
+
+    vector.fillInt(vectorInts + Random::LANES, Random::LANES, 0, 1000);
+    scalar.fillInt(scalarInts + Random::LANES, Random::LANES, 0, 1000);
+    CHECK(std::equal(scalarInts + Random::LANES, scalarInts + Random::LANES * 2, vectorInts + Random::LANES));
+  }
+
+  // filled numbers stay in range, including the full int range which skips the vector path
+  void testFillStaysInRange()
+  {
+    Random random(3);
+    std::vector<int> ints(1001);
+    random.fillInt(ints.data(), ints.size(), -3, 3);
+    CHECK(*std::min_element(ints.begin(), ints.end()) == -3);
+    CHECK(*std::max_element(ints.begin(), ints.end()) == 3);
+
+    random.fillInt(ints.data(), ints.size(), 7, 7);
+    CHECK(std::all_of(ints.begin(), ints.end(), [](int value) { return value == 7; }));
+
+    random.fillInt(ints.data(), ints.size(), INT_MIN, INT_MAX);
+    CHECK(std::any_of(ints.begin(), ints.end(), [](int value) { return value < 0; }));
+    CHECK(std::any_of(ints.begin(), ints.end(), [](int value) { return value > 0; }));
+
+    std::vector<double> doubles(1001);
+    random.fillDouble(doubles.data(), doubles.size(), -2.0, 2.0);
+    CHECK(std::all_of(doubles.begin(), doubles.end(), [](double value) { return value >= -2.0 && value < 2.0; }));
+  }
+
+  // the single number functions stay in range
+  void testNextStaysInRange()
+  {
+    Random random(11);
+    bool inRange = true;
+    for (int i = 0; i < 10000; ++i)
+    {
+      int value = random.nextInt(-5, 5);
+      double real = random.nextDouble(1.0, 2.0);
+      float single = random.nextFloat(-1.0f, 0.0f);
+      inRange &= value >= -5 && value <= 5 && real >= 1.0 && real < 2.0 && single >= -1.0f && single < 0.0f;
+    }
+    CHECK(inRange);
+  }
+
+  // the fill lanes are separate from the generator behind next()
+  void testFillDoesNotDisturbNext()
+  {
+    Random plain(21);
+    Random filled(21);
+    int ints[64];
+    filled.fillInt(ints, 64, 0, 10);
+    CHECK(plain.next() == filled.next());
+  }
+
+  // every thread gets a generator on a stream of its own
+  void testThreadsGetTheirOwnStreams()
+  {
+    Random::seedThreads(42);
+    std::uint32_t fromThreads[2] = {};
+    std::thread first([&]() { fromThreads[0] = Random::forThisThread().next(); });
+    std::thread second([&]() { fromThreads[1] = Random::forThisThread().next(); });
+    first.join();
+    second.join();
+    CHECK(fromThreads[0] != fromThreads[1]);
+    CHECK(&Random::forThisThread() == &Random::forThisThread());
+  }
+}
+
+int main()
+{
+  testSeedAndStreamAreDeterministic();
+  testFillIsIndependentOfChunking();
+  testPartialFillMatchesWholeFill();
+  testFillStaysInRange();
+  testNextStaysInRange();
+  testFillDoesNotDisturbNext();
+  testThreadsGetTheirOwnStreams();
+  return finishTests("random");
+}
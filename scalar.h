@@ -0,0 +1,149 @@
+#ifndef SCALAR_H
+#define SCALAR_H
+
+#include <cstdint>
+#include <limits>
+
+namespace gamelib
+{
+
+  /*
+
+  Fixed16
+    - a signed 16.16 fixed point number: 16 bits of whole pixels, 16 bits of fraction
+    - integer arithmetic gives the same bits on every machine and compiler, which is what
+      lockstep networking and replays need
+    - the range is about -32768 to 32767, which is plenty for positions and velocities
+      in pixels and pixels per second
+    - converting a double outside the range saturates to the nearest end of the range (NaN
+      becomes zero); arithmetic whose result leaves the range wraps around like unsigned
+      integers do, so even an overflow gives the same bits on every machine
+    - converts implicitly from double so that literals and time steps mix freely with it;
+      converting back is explicit
+
+  */
+
+  // FIXED16 CLASS
+  class Fixed16
+  {
+  protected:
+    std::int32_t raw;
+
+    // the low 32 bits as a signed value, results outside the range wrap around
+    static constexpr std::int32_t wrap(std::uint32_t bits) { return static_cast<std::int32_t>(bits); }
+    static constexpr std::int32_t wrap(std::int64_t bits) { return wrap(static_cast<std::uint32_t>(static_cast<std::uint64_t>(bits))); }
+
+    // scales, rounds to nearest and saturates
+    static constexpr std::int32_t rawFromDouble(double value)
+    {
+      double scaled = value * ONE;
+      return !(scaled == scaled) ? 0
+             : scaled >= static_cast<double>(std::numeric_limits<std::int32_t>::max()) ? std::numeric_limits<std::int32_t>::max()
+             : scaled <= static_cast<double>(std::numeric_limits<std::int32_t>::min()) ? std::numeric_limits<std::int32_t>::min()
+                                                                                       : static_cast<std::int32_t>(scaled + (scaled >= 0.0 ? 0.5 : -0.5));
+    }
+
+  public:
+    static constexpr int FRACTION_BITS = 16;
+    static constexpr double ONE = 65536.0;
+
+    Fixed16() = default;
+
+    // converts with round to nearest, saturating outside of the range
+    constexpr Fixed16(double value) : raw(rawFromDouble(value)) {}
+
+    // builds a value from its raw bits
+    static constexpr Fixed16 fromRaw(std::int32_t bits)
+    {
+      Fixed16 value(0.0);
+      value.raw = bits;
+      return value;
+    }
+
+    constexpr std::int32_t getRaw() const { return raw; }
+
+    constexpr double toDouble() const { return raw / ONE; }
+    explicit constexpr operator double() const { return toDouble(); }
+    explicit constexpr operator float() const { return static_cast<float>(toDouble()); }
+
+    constexpr Fixed16 operator-() const { return fromRaw(wrap(0u - static_cast<std::uint32_t>(raw))); }
+
+    Fixed16 &operator+=(Fixed16 other)
+    {
+      raw = wrap(static_cast<std::uint32_t>(raw) + static_cast<std::uint32_t>(other.raw));
+      return *this;
+    }
+
+    Fixed16 &operator-=(Fixed16 other)
+    {
+      raw = wrap(static_cast<std::uint32_t>(raw) - static_cast<std::uint32_t>(other.raw));
+      return *this;
+    }
+
+    // the 64 bit product cannot overflow, only the part which does not fit back in 32 bits wraps
+    Fixed16 &operator*=(Fixed16 other)
+    {
+      raw = wrap((static_cast<std::int64_t>(raw) * other.raw) >> FRACTION_BITS);
+      return *this;
+    }
+
+    // dividing by zero saturates toward the sign of the dividend
+    Fixed16 &operator/=(Fixed16 other)
+    {
+      if (other.raw == 0)
+      {
+        raw = raw < 0 ? std::numeric_limits<std::int32_t>::min() : std::numeric_limits<std::int32_t>::max();
+        return *this;
+      }
+      raw = wrap(static_cast<std::int64_t>(raw) * (std::int64_t(1) << FRACTION_BITS) / other.raw);
+      return *this;
+    }
+
+    friend Fixed16 operator+(Fixed16 a, Fixed16 b) { return a += b; }
+    friend Fixed16 operator-(Fixed16 a, Fixed16 b) { return a -= b; }
+    friend Fixed16 operator*(Fixed16 a, Fixed16 b) { return a *= b; }
+    friend Fixed16 operator/(Fixed16 a, Fixed16 b) { return a /= b; }
+
+    friend bool operator==(Fixed16 a, Fixed16 b) { return a.raw == b.raw; }
+    friend bool operator!=(Fixed16 a, Fixed16 b) { return a.raw != b.raw; }
+    friend bool operator<(Fixed16 a, Fixed16 b) { return a.raw < b.raw; }
+    friend bool operator>(Fixed16 a, Fixed16 b) { return a.raw > b.raw; }
+    friend bool operator<=(Fixed16 a, Fixed16 b) { return a.raw <= b.raw; }
+    friend bool operator>=(Fixed16 a, Fixed16 b) { return a.raw >= b.raw; }
+  };
+
+  /*
+
+  StateScalar
+    - the type positions and velocities are stored in: Entity, BulletPool, the bullet pattern
+      tables and the Position and Velocity components
+    - chosen at compile time (make STATE=float|double|fixed):
+        float (the default)     half the memory of double, plenty of precision for pixels
+        GAMELIB_STATE_DOUBLE    the original double precision state
+        GAMELIB_STATE_FIXED     16.16 fixed point, bit-exact on every machine
+    - use toState() and fromState() at the boundaries so code reads the same in every mode
+
+  */
+
+#if defined(GAMELIB_STATE_FIXED)
+  using StateScalar = Fixed16;
+#elif defined(GAMELIB_STATE_DOUBLE)
+  using StateScalar = double;
+#else
+  using StateScalar = float;
+#endif
+
+  // converts a double into the state representation
+  inline StateScalar toState(double value)
+  {
+    return static_cast<StateScalar>(value);
+  }
+
+  // converts a state value back into a double
+  inline double fromState(StateScalar value)
+  {
+    return static_cast<double>(value);
+  }
+}
+
+#endif
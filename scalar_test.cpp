@@ -0,0 +1,89 @@
+#include "scalar.h"
+#include "testing.h"
+
+#include <cmath>
+#include <limits>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  constexpr std::int32_t RAW_MAX = std::numeric_limits<std::int32_t>::max();
+  constexpr std::int32_t RAW_MIN = std::numeric_limits<std::int32_t>::min();
+
+  // values in the range convert with round to nearest and back exactly
+  void testConversionRoundsToNearest()
+  {
+    CHECK(Fixed16(1.0).getRaw() == 65536);
+    CHECK(Fixed16(-1.5).getRaw() == -98304);
+    CHECK(Fixed16(0.25).toDouble() == 0.25);
+    CHECK(Fixed16(1.0 / 65536.0 * 0.6).getRaw() == 1);
+    CHECK(Fixed16(-1.0 / 65536.0 * 0.6).getRaw() == -1);
+    CHECK(static_cast<double>(Fixed16(1234.5)) == 1234.5);
+  }
+
+  // doubles outside the range saturate and NaN becomes zero
+  void testConversionSaturates()
+  {
+    CHECK(Fixed16(40000.0).getRaw() == RAW_MAX);
+    CHECK(Fixed16(-40000.0).getRaw() == RAW_MIN);
+    CHECK(Fixed16(std::numeric_limits<double>::infinity()).getRaw() == RAW_MAX);
+    CHECK(Fixed16(-std::numeric_limits<double>::infinity()).getRaw() == RAW_MIN);
+    CHECK(Fixed16(std::nan("")).getRaw() == 0);
+  }
+
+  // arithmetic in the range is exact for values which fit in 16.16
+  void testArithmetic()
+  {
+    CHECK(Fixed16(1.5) + Fixed16(2.25) == Fixed16(3.75));
+    CHECK(Fixed16(1.5) - Fixed16(2.25) == Fixed16(-0.75));
+    CHECK(Fixed16(1.5) * Fixed16(-2.0) == Fixed16(-3.0));
+    CHECK(Fixed16(7.5) / Fixed16(2.5) == Fixed16(3.0));
+    CHECK(-Fixed16(2.0) == Fixed16(-2.0));
+    CHECK(Fixed16(-1.0) < Fixed16(0.5));
+  }
+
+  // results which leave the range wrap around instead of being undefined
+  void testOverflowWraps()
+  {
+    Fixed16 largest = Fixed16::fromRaw(RAW_MAX);
+    Fixed16 smallest = Fixed16::fromRaw(RAW_MIN);
+    Fixed16 step = Fixed16::fromRaw(1);
+
+    CHECK((largest + step).getRaw() == RAW_MIN);
+    CHECK((smallest - step).getRaw() == RAW_MAX);
+    CHECK((-smallest).getRaw() == RAW_MIN);
+
+    // 200 * 200 = 40000 is out of range, the low 32 bits of the raw product remain
+    CHECK((Fixed16(200.0) * Fixed16(200.0)).getRaw() == static_cast<std::int32_t>(static_cast<std::uint32_t>(40000u << 16)));
+    CHECK((smallest / Fixed16(-1.0)).getRaw() == RAW_MIN);
+  }
+
+  // dividing by zero saturates toward the sign of the dividend
+  void testDivisionByZeroSaturates()
+  {
+    CHECK((Fixed16(3.0) / Fixed16(0.0)).getRaw() == RAW_MAX);
+    CHECK((Fixed16(-3.0) / Fixed16(0.0)).getRaw() == RAW_MIN);
+    CHECK((Fixed16(0.0) / Fixed16(0.0)).getRaw() == RAW_MAX);
+  }
+
+  // the state helpers round trip pixel sized values in every StateScalar
+  void testStateRoundTrip()
+  {
+    CHECK(fromState(toState(123.5)) == 123.5);
+    CHECK(fromState(toState(-0.25)) == -0.25);
+    CHECK(toState(2.0) * toState(3.0) == toState(6.0));
+  }
+}
+
+int main()
+{
+  testConversionRoundsToNearest();
+  testConversionSaturates();
+  testArithmetic();
+  testOverflowWraps();
+  testDivisionByZeroSaturates();
+  testStateRoundTrip();
+  return finishTests("scalar");
+}
@@ -0,0 +1,485 @@
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  // which StateScalar the snapshot was saved with, state from another build cannot be restored
+#if defined(GAMELIB_STATE_FIXED)
+  constexpr std::uint16_t STATE_FORMAT = 2;
+#elif defined(GAMELIB_STATE_DOUBLE)
+  constexpr std::uint16_t STATE_FORMAT = 1;
+#else
+  constexpr std::uint16_t STATE_FORMAT = 0;
+#endif
+
+  // header: magic, version, state format, section count, unused, total bytes
+  constexpr std::size_t SECTION_COUNT_OFFSET = 8;
+  constexpr std::size_t TOTAL_BYTES_OFFSET = 16;
+  constexpr std::size_t HEADER_BYTES = 24;
+
+  // section header: type, payload bytes
+  constexpr std::size_t SECTION_HEADER_BYTES = 8;
+
+  // entity record: archetype, chunk, row, generation, alive
+  constexpr std::size_t RECORD_BYTES = 17;
+
+  // a file mapped into memory, unmapped and closed when destroyed
+  struct FileMapping
+  {
+    int file = -1;
+    void *address = MAP_FAILED;
+    std::size_t length = 0;
+
+    ~FileMapping()
+    {
+      if (address != MAP_FAILED)
+      {
+        munmap(address, length);
+      }
+      if (file != -1)
+      {
+        close(file);
+      }
+    }
+  };
+}
+
+// creates an empty snapshot with room for reserveBytes bytes
+Snapshot::Snapshot(std::size_t reserveBytes) : data(),
+                                               readOffset(HEADER_BYTES),
+                                               sectionStart(0)
+{
+  data.reserve(reserveBytes);
+  beginSave();
+}
+
+// appends raw bytes to the buffer
+void Snapshot::write(const void *bytes, std::size_t count)
+{
+  const unsigned char *from = static_cast<const unsigned char *>(bytes);
+  data.insert(data.end(), from, from + count);
+}
+
+// grows the buffer by count bytes and returns where they start
+unsigned char *Snapshot::append(std::size_t count)
+{
+  data.resize(data.size() + count);
+  return data.data() + data.size() - count;
+}
+
+// copies raw bytes out of the buffer, throws when the snapshot is too short
+void Snapshot::read(void *bytes, std::size_t count)
+{
+  std::memcpy(bytes, consume(count), count);
+}
+
+// skips count bytes and returns where they start, throws when the snapshot is too short
+const unsigned char *Snapshot::consume(std::size_t count)
+{
+  if (count > data.size() - readOffset)
+  {
+    throw std::runtime_error("Unable to restore snapshot: it is truncated");
+  }
+  const unsigned char *bytes = data.data() + readOffset;
+  readOffset += count;
+  return bytes;
+}
+
+// throws away the saved state and starts a new snapshot
+void Snapshot::beginSave()
+{
+  data.clear();
+  writeValue(MAGIC);
+  writeValue(VERSION);
+  writeValue(STATE_FORMAT);
+  writeValue(std::uint32_t(0));
+  writeValue(std::uint32_t(0));
+  writeValue(std::uint64_t(HEADER_BYTES));
+  readOffset = HEADER_BYTES;
+}
+
+// starts a section of the given type, finished by endSection()
+void Snapshot::beginSection(SectionType type)
+{
+  sectionStart = data.size();
+  writeValue(static_cast<std::uint32_t>(type));
+  writeValue(std::uint32_t(0));
+}
+
+// patches the size of the section and the header of the snapshot
+void Snapshot::endSection()
+{
+  std::uint32_t payloadBytes = static_cast<std::uint32_t>(data.size() - sectionStart - SECTION_HEADER_BYTES);
+  std::memcpy(data.data() + sectionStart + sizeof(std::uint32_t), &payloadBytes, sizeof(payloadBytes));
+
+  std::uint32_t sectionCount;
+  std::memcpy(&sectionCount, data.data() + SECTION_COUNT_OFFSET, sizeof(sectionCount));
+  ++sectionCount;
+  std::memcpy(data.data() + SECTION_COUNT_OFFSET, &sectionCount, sizeof(sectionCount));
+
+  std::uint64_t totalBytes = data.size();
+  std::memcpy(data.data() + TOTAL_BYTES_OFFSET, &totalBytes, sizeof(totalBytes));
+}
+
+// moves past the header of the next section, throws when it is not of the given type
+void Snapshot::expectSection(SectionType type)
+{
+  std::uint32_t savedType = readValue<std::uint32_t>();
+  std::uint32_t payloadBytes = readValue<std::uint32_t>();
+  if (savedType != static_cast<std::uint32_t>(type))
+  {
+    throw std::runtime_error("Unable to restore snapshot: expected section " + std::to_string(static_cast<std::uint32_t>(type)) +
+                             " but found section " + std::to_string(savedType));
+  }
+  if (payloadBytes > data.size() - readOffset)
+  {
+    throw std::runtime_error("Unable to restore snapshot: it is truncated");
+  }
+}
+
+// checks the header and moves to the first section
+void Snapshot::validate()
+{
+  if (data.size() < HEADER_BYTES)
+  {
+    throw std::runtime_error("Unable to restore snapshot: it is truncated");
+  }
+  readOffset = 0;
+  std::uint32_t magic = readValue<std::uint32_t>();
+  std::uint16_t version = readValue<std::uint16_t>();
+  std::uint16_t stateFormat = readValue<std::uint16_t>();
+  readValue<std::uint32_t>();
+  readValue<std::uint32_t>();
+  std::uint64_t totalBytes = readValue<std::uint64_t>();
+  if (magic != MAGIC)
+  {
+    throw std::runtime_error("Unable to restore snapshot: not a snapshot");
+  }
+  if (version != VERSION)
+  {
+    throw std::runtime_error("Unable to restore snapshot: version " + std::to_string(version) +
+                             " is not supported, expected version " + std::to_string(VERSION));
+  }
+  if (stateFormat != STATE_FORMAT)
+  {
+    throw std::runtime_error("Unable to restore snapshot: it was saved with a different StateScalar");
+  }
+  if (totalBytes != data.size())
+  {
+    throw std::runtime_error("Unable to restore snapshot: it is truncated");
+  }
+}
+
+// goes back to the first section so that the snapshot can be restored (again)
+void Snapshot::rewind()
+{
+  validate();
+}
+
+void Snapshot::save(const Entity &entity)
+{
+  beginSection(SectionType::Entity);
+  writeValue(static_cast<std::uint64_t>(Entity::nextEntityId));
+  writeValue(static_cast<std::uint64_t>(entity.id));
+  writeValue(entity.worldPositionX);
+  writeValue(entity.worldPositionY);
+  writeValue(entity.velocityX);
+  writeValue(entity.velocityY);
+  writeValue(static_cast<std::uint8_t>(entity.active));
+  writeValue(static_cast<std::uint8_t>(entity.visible));
+  writeValue(static_cast<std::uint32_t>(entity.tags.size()));
+  for (auto &tag : entity.tags)
+  {
+    writeValue(static_cast<std::uint32_t>(tag.size()));
+    write(tag.data(), tag.size());
+  }
+  endSection();
+}
+
+void Snapshot::restore(Entity &entity)
+{
+  expectSection(SectionType::Entity);
+  // only ever move the id counter forward, entities created since the snapshot keep unique ids
+  Entity::nextEntityId = std::max(Entity::nextEntityId, static_cast<unsigned long>(readValue<std::uint64_t>()));
+  entity.id = static_cast<unsigned long>(readValue<std::uint64_t>());
+  entity.worldPositionX = readValue<StateScalar>();
+  entity.worldPositionY = readValue<StateScalar>();
+  entity.velocityX = readValue<StateScalar>();
+  entity.velocityY = readValue<StateScalar>();
+  entity.active = readValue<std::uint8_t>() != 0;
+  entity.visible = readValue<std::uint8_t>() != 0;
+  std::uint32_t tagCount = readValue<std::uint32_t>();
+  entity.tags.clear();
+  for (std::uint32_t i = 0; i < tagCount; ++i)
+  {
+    std::uint32_t length = readValue<std::uint32_t>();
+    entity.tags.emplace(reinterpret_cast<const char *>(consume(length)), length);
+  }
+}
+
+void Snapshot::save(const World &world)
+{
+  beginSection(SectionType::World);
+
+  std::uint32_t registeredCount = 0;
+  for (auto &info : world.components)
+  {
+    registeredCount += info.registered ? 1 : 0;
+  }
+  writeValue(registeredCount);
+  for (std::uint32_t componentId = 0; componentId < World::MAX_COMPONENTS; ++componentId)
+  {
+    const World::ComponentInfo &info = world.components[componentId];
+    if (info.registered)
+    {
+      writeValue(componentId);
+      writeValue(info.size);
+      writeValue(info.alignment);
+    }
+  }
+
+  // records are packed field by field so that no padding bytes end up in the snapshot
+  writeValue(static_cast<std::uint32_t>(world.records.size()));
+  unsigned char *packed = append(world.records.size() * RECORD_BYTES);
+  for (auto &record : world.records)
+  {
+    std::uint32_t fields[4] = {record.archetype, record.chunk, record.row, record.generation};
+    std::memcpy(packed, fields, sizeof(fields));
+    packed[sizeof(fields)] = record.alive ? 1 : 0;
+    packed += RECORD_BYTES;
+  }
+  writeValue(static_cast<std::uint32_t>(world.freeRecords.size()));
+  write(world.freeRecords.data(), world.freeRecords.size() * sizeof(std::uint32_t));
+  writeValue(static_cast<std::uint64_t>(world.liveCount));
+
+  // every archetype is saved, even empty ones, so that the archetype index in each record stays meaningful
+  writeValue(static_cast<std::uint32_t>(world.archetypes.size()));
+  for (auto &archetype : world.archetypes)
+  {
+    writeValue(archetype.mask);
+    writeValue(static_cast<std::uint64_t>(archetype.count));
+    for (std::size_t chunkIndex = 0; chunkIndex * archetype.capacity < archetype.count; ++chunkIndex)
+    {
+      std::size_t rows = std::min(archetype.count - chunkIndex * archetype.capacity, archetype.capacity);
+      const unsigned char *chunk = archetype.chunks[chunkIndex].get();
+      write(chunk, rows * sizeof(EntityHandle));
+      for (ComponentMask remaining = archetype.mask; remaining != 0; remaining &= remaining - 1)
+      {
+        unsigned componentId = static_cast<unsigned>(__builtin_ctzll(remaining));
+        std::uint32_t componentSize = world.components[componentId].size;
+        write(chunk + archetype.offsets[componentId], rows * componentSize);
+      }
+    }
+  }
+
+  endSection();
+}
+
+void Snapshot::restore(World &world)
+{
+  expectSection(SectionType::World);
+
+  std::uint32_t registeredCount = readValue<std::uint32_t>();
+  for (std::uint32_t i = 0; i < registeredCount; ++i)
+  {
+    std::uint32_t componentId = readValue<std::uint32_t>();
+    std::uint32_t componentSize = readValue<std::uint32_t>();
+    std::uint32_t alignment = readValue<std::uint32_t>();
+    if (componentId >= World::MAX_COMPONENTS)
+    {
+      throw std::runtime_error("Unable to restore snapshot: component id " + std::to_string(componentId) + " is out of range");
+    }
+    World::ComponentInfo &info = world.components[componentId];
+    if (info.registered && (info.size != componentSize || info.alignment != alignment))
+    {
+      throw std::runtime_error("Unable to restore snapshot: component id " + std::to_string(componentId) + " has changed layout");
+    }
+    info = {componentSize, alignment, true};
+  }
+
+  std::uint32_t recordCount = readValue<std::uint32_t>();
+  const unsigned char *packed = consume(static_cast<std::size_t>(recordCount) * RECORD_BYTES);
+  world.records.resize(recordCount);
+  for (auto &record : world.records)
+  {
+    std::uint32_t fields[4];
+    std::memcpy(fields, packed, sizeof(fields));
+    record.archetype = fields[0];
+    record.chunk = fields[1];
+    record.row = fields[2];
+    record.generation = fields[3];
+    record.alive = packed[sizeof(fields)] != 0;
+    packed += RECORD_BYTES;
+  }
+  std::uint32_t freeCount = readValue<std::uint32_t>();
+  world.freeRecords.resize(freeCount);
+  read(world.freeRecords.data(), freeCount * sizeof(std::uint32_t));
+  world.liveCount = static_cast<std::size_t>(readValue<std::uint64_t>());
+
+  // archetypes the snapshot does not mention end up empty
+  for (auto &archetype : world.archetypes)
+  {
+    archetype.count = 0;
+  }
+
+  // the world may have created its archetypes in another order, so the archetype of every
+  // live record is pointed at the world's own archetype as its rows are restored
+  std::uint32_t archetypeCount = readValue<std::uint32_t>();
+  for (std::uint32_t savedIndex = 0; savedIndex < archetypeCount; ++savedIndex)
+  {
+    ComponentMask mask = readValue<ComponentMask>();
+    std::size_t count = static_cast<std::size_t>(readValue<std::uint64_t>());
+    std::uint32_t archetypeIndex = world.findOrCreateArchetype(mask);
+
+    World::Archetype &archetype = world.archetypes[archetypeIndex];
+    archetype.count = count;
+    for (std::size_t chunkIndex = 0; chunkIndex * archetype.capacity < count; ++chunkIndex)
+    {
+      if (chunkIndex == archetype.chunks.size())
+      {
+        archetype.chunks.emplace_back(new unsigned char[archetype.chunkBytes]);
+      }
+      std::size_t rows = std::min(count - chunkIndex * archetype.capacity, archetype.capacity);
+      unsigned char *chunk = archetype.chunks[chunkIndex].get();
+      read(chunk, rows * sizeof(EntityHandle));
+      const EntityHandle *handles = World::handleColumn(chunk);
+      for (std::size_t row = 0; row < rows; ++row)
+      {
+        if (handles[row].index >= world.records.size())
+        {
+          throw std::runtime_error("Unable to restore snapshot: entity " + std::to_string(handles[row].index) + " has no record");
+        }
+        world.records[handles[row].index].archetype = archetypeIndex;
+      }
+      for (ComponentMask remaining = mask; remaining != 0; remaining &= remaining - 1)
+      {
+        unsigned componentId = static_cast<unsigned>(__builtin_ctzll(remaining));
+        read(chunk + archetype.offsets[componentId], rows * world.components[componentId].size);
+      }
+    }
+  }
+}
+
+void Snapshot::save(const BulletPool &pool)
+{
+  beginSection(SectionType::BulletPool);
+  writeValue(static_cast<std::uint64_t>(pool.count));
+  write(pool.positionX.data(), pool.count * sizeof(StateScalar));
+  write(pool.positionY.data(), pool.count * sizeof(StateScalar));
+  write(pool.velocityX.data(), pool.count * sizeof(StateScalar));
+  write(pool.velocityY.data(), pool.count * sizeof(StateScalar));
+  endSection();
+}
+
+void Snapshot::restore(BulletPool &pool)
+{
+  expectSection(SectionType::BulletPool);
+  std::size_t count = static_cast<std::size_t>(readValue<std::uint64_t>());
+  if (count > pool.capacity)
+  {
+    throw std::runtime_error("Unable to restore snapshot: " + std::to_string(count) + " bullets do not fit in a pool of " + std::to_string(pool.capacity));
+  }
+  pool.count = count;
+  read(pool.positionX.data(), count * sizeof(StateScalar));
+  read(pool.positionY.data(), count * sizeof(StateScalar));
+  read(pool.velocityX.data(), count * sizeof(StateScalar));
+  read(pool.velocityY.data(), count * sizeof(StateScalar));
+}
+
+void Snapshot::save(const BulletEmitter &emitter)
+{
+  beginSection(SectionType::BulletEmitter);
+  writeValue(emitter.fireTime);
+  writeValue(emitter.orientationX);
+  writeValue(emitter.orientationY);
+  endSection();
+}
+
+void Snapshot::restore(BulletEmitter &emitter)
+{
+  expectSection(SectionType::BulletEmitter);
+  emitter.fireTime = readValue<double>();
+  emitter.orientationX = readValue<double>();
+  emitter.orientationY = readValue<double>();
+}
+
+void Snapshot::save(const Random &random)
+{
+  beginSection(SectionType::Random);
+  writeValue(random.state);
+  writeValue(random.increment);
+  write(random.laneState, sizeof(random.laneState));
+  endSection();
+}
+
+void Snapshot::restore(Random &random)
+{
+  expectSection(SectionType::Random);
+  random.state = readValue<std::uint64_t>();
+  random.increment = readValue<std::uint64_t>();
+  read(random.laneState, sizeof(random.laneState));
+}
+
+// replaces the snapshot with a copy of size bytes of a saved snapshot and rewinds it
+void Snapshot::loadFromMemory(const void *bytes, std::size_t size)
+{
+  const unsigned char *from = static_cast<const unsigned char *>(bytes);
+  data.assign(from, from + size);
+  validate();
+}
+
+// writes the snapshot to a file, replacing it
+void Snapshot::saveToFile(const std::string &path) const
+{
+  FileMapping mapping;
+  mapping.file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (mapping.file == -1)
+  {
+    throw std::runtime_error("Unable to open snapshot file for writing:" + path);
+  }
+  if (ftruncate(mapping.file, static_cast<off_t>(data.size())) != 0)
+  {
+    throw std::runtime_error("Unable to resize snapshot file:" + path);
+  }
+  mapping.length = data.size();
+  mapping.address = mmap(nullptr, mapping.length, PROT_READ | PROT_WRITE, MAP_SHARED, mapping.file, 0);
+  if (mapping.address == MAP_FAILED)
+  {
+    throw std::runtime_error("Unable to map snapshot file:" + path);
+  }
+  std::memcpy(mapping.address, data.data(), data.size());
+}
+
+// replaces the snapshot with the one saved in a file and rewinds it
+void Snapshot::loadFromFile(const std::string &path)
+{
+  FileMapping mapping;
+  mapping.file = open(path.c_str(), O_RDONLY);
+  if (mapping.file == -1)
+  {
+    throw std::runtime_error("Unable to open snapshot file:" + path);
+  }
+  struct stat fileStatus;
+  if (fstat(mapping.file, &fileStatus) != 0 || fileStatus.st_size < static_cast<off_t>(HEADER_BYTES))
+  {
+    throw std::runtime_error("Unable to read snapshot file:" + path);
+  }
+  mapping.length = static_cast<std::size_t>(fileStatus.st_size);
+  mapping.address = mmap(nullptr, mapping.length, PROT_READ, MAP_PRIVATE, mapping.file, 0);
+  if (mapping.address == MAP_FAILED)
+  {
+    throw std::runtime_error("Unable to map snapshot file:" + path);
+  }
+  loadFromMemory(mapping.address, mapping.length);
+}
@@ -0,0 +1,141 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "entity.h"
+#include "ecs.h"
+#include "bullets.h"
+#include "random.h"
+
+namespace gamelib
+{
+
+  /*
+
+  Snapshot
+    - a versioned binary image of game state held in one contiguous memory buffer
+    - the buffer starts with a header (magic number, format version, the StateScalar
+      representation it was saved with) followed by one section per saved object
+    - objects are saved and restored in the same order: beginSave() then save() each
+      object, rewind() then restore() each object; restoring an object of the wrong type
+      or from a snapshot saved with another version or StateScalar throws
+    - values are stored in the byte order of the machine, bulk state (bullets, chunks of
+      components) is copied with memcpy, so saving and restoring takes microseconds
+    - the buffer is reused between saves, so once it has grown to fit the state, taking a
+      snapshot every frame (rollback) does not allocate
+    - a World restores into the chunks it already has and adopts the component sizes in the
+      snapshot; component types must keep their ids and layout between save and restore
+    - components are copied byte for byte, so pointers inside them are garbage after a restore;
+      components which need one keep an index instead and are fixed up after restoring
+      (resolveWeaponPatterns() does this for the pattern of every Weapon)
+    - restoring an Entity restores its id; the counter for new ids only ever moves forward,
+      so restoring never hands out an id which is already in use
+    - files are written and read through a memory mapping of the whole file
+
+  */
+
+  // SNAPSHOT CLASS
+  class Snapshot
+  {
+  public:
+    // "GSNP" in the first four bytes of the file
+    static constexpr std::uint32_t MAGIC = 0x504e5347;
+
+    // bumped whenever the layout of any section changes
+    static constexpr std::uint16_t VERSION = 1;
+
+  protected:
+    // SECTION TYPE ENUM
+    enum class SectionType : std::uint32_t
+    {
+      Entity = 1,
+      World = 2,
+      BulletPool = 3,
+      BulletEmitter = 4,
+      Random = 5
+    };
+
+    std::vector<unsigned char> data;
+    std::size_t readOffset;
+    std::size_t sectionStart;
+
+    // appends raw bytes to the buffer
+    void write(const void *bytes, std::size_t count);
+
+    // grows the buffer by count bytes and returns where they start, for packing many small values
+    unsigned char *append(std::size_t count);
+
+    template <typename T>
+    void writeValue(const T &value)
+    {
+      write(&value, sizeof(T));
+    }
+
+    // copies raw bytes out of the buffer, throws when the snapshot is too short
+    void read(void *bytes, std::size_t count);
+
+    // skips count bytes and returns where they start, throws when the snapshot is too short
+    const unsigned char *consume(std::size_t count);
+
+    template <typename T>
+    T readValue()
+    {
+      T value;
+      read(&value, sizeof(T));
+      return value;
+    }
+
+    // starts a section of the given type, finished by endSection()
+    void beginSection(SectionType type);
+
+    // patches the size of the section and the header of the snapshot
+    void endSection();
+
+    // moves past the header of the next section, throws when it is not of the given type
+    void expectSection(SectionType type);
+
+    // checks the header and moves to the first section
+    void validate();
+
+  public:
+    // creates an empty snapshot with room for reserveBytes bytes
+    explicit Snapshot(std::size_t reserveBytes = 0);
+
+    // throws away the saved state and starts a new snapshot
+    void beginSave();
+
+    void save(const Entity &entity);
+    void save(const World &world);
+    void save(const BulletPool &pool);
+    void save(const BulletEmitter &emitter);
+    void save(const Random &random);
+
+    // goes back to the first section so that the snapshot can be restored (again)
+    void rewind();
+
+    void restore(Entity &entity);
+    void restore(World &world);
+    void restore(BulletPool &pool);
+    void restore(BulletEmitter &emitter);
+    void restore(Random &random);
+
+    // replaces the snapshot with a copy of size bytes of a saved snapshot and rewinds it
+    void loadFromMemory(const void *bytes, std::size_t size);
+
+    // writes the snapshot to a file, replacing it
+    void saveToFile(const std::string &path) const;
+
+    // replaces the snapshot with the one saved in a file and rewinds it
+    void loadFromFile(const std::string &path);
+
+    // the whole snapshot, header included
+    const unsigned char *getData() const { return data.data(); }
+    std::size_t size() const { return data.size(); }
+  };
+}
+
+#endif
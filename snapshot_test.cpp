@@ -0,0 +1,196 @@
+#include "snapshot.h"
+#include "components.h"
+#include "testing.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// within this file we want to declare that we can see within the namespace of the class
+using namespace gamelib;
+
+namespace
+{
+  const char *SNAPSHOT_PATH = "snapshot_test.snapshot";
+
+  // a copy of the bytes of a snapshot, for tampering with
+  std::vector<unsigned char> bytesOf(const Snapshot &snapshot)
+  {
+    return std::vector<unsigned char>(snapshot.getData(), snapshot.getData() + snapshot.size());
+  }
+
+  // every kind of state comes back as it was saved
+  void testRoundTrip()
+  {
+    const char *tags[] = {"Player", nullptr};
+    Entity player(10.0, 20.0, 3.0, 4.0, tags);
+
+    BulletPool pool(64);
+    BulletPattern pattern = BulletPattern::ring(8, 100.0);
+    BulletEmitter emitter(&pattern, 0.1);
+    emitter.setDirection(0.0, 1.0);
+    emitter.fire(pool, 5.0, 5.0);
+    emitter.update(pool, 0.0, 0.0, 0.05);
+
+    Random random(77);
+    random.next();
+
+    World world;
+    EntityHandle kept = world.create(Position{toState(1), toState(2)}, Velocity{toState(3), toState(4)});
+    EntityHandle destroyed = world.create(Position{toState(5), toState(6)});
+    world.destroy(destroyed);
+
+    Snapshot snapshot;
+    snapshot.save(player);
+    snapshot.save(world);
+    snapshot.save(pool);
+    snapshot.save(emitter);
+    snapshot.save(random);
+
+    // change everything, then restore it
+    Entity restoredPlayer;
+    World restoredWorld;
+    BulletPool restoredPool(64);
+    BulletEmitter restoredEmitter(&pattern, 0.1);
+    Random restoredRandom(1);
+    snapshot.rewind();
+    snapshot.restore(restoredPlayer);
+    snapshot.restore(restoredWorld);
+    snapshot.restore(restoredPool);
+    snapshot.restore(restoredEmitter);
+    snapshot.restore(restoredRandom);
+
+    CHECK(restoredPlayer == player);
+    CHECK(restoredPlayer.getWorldPositionX() == 10.0 && restoredPlayer.getVelocityY() == 4.0);
+    CHECK(restoredPlayer.hasTag("Player"));
+
+    CHECK(restoredWorld.size() == 1);
+    CHECK(restoredWorld.isAlive(kept));
+    CHECK(!restoredWorld.isAlive(destroyed));
+    CHECK(restoredWorld.get<Velocity>(kept)->y == toState(4));
+
+    CHECK(restoredPool.size() == pool.size());
+    bool sameBullets = true;
+    for (std::size_t i = 0; i < pool.size(); ++i)
+    {
+      sameBullets &= restoredPool.getPositionX(i) == pool.getPositionX(i) && restoredPool.getVelocityY(i) == pool.getVelocityY(i);
+    }
+    CHECK(sameBullets);
+
+    // the emitter carries on with the same orientation and firing clock
+    BulletPool next(64);
+    BulletPool restoredNext(64);
+    CHECK(emitter.update(next, 0.0, 0.0, 0.05) == restoredEmitter.update(restoredNext, 0.0, 0.0, 0.05));
+    CHECK(next.size() == 8 && restoredNext.size() == 8);
+    CHECK(next.getVelocityX(1) == restoredNext.getVelocityX(1));
+
+    // both generators continue the same sequences, the fill lanes included
+    int filled[8];
+    int restoredFilled[8];
+    random.fillInt(filled, 8, 0, 1000);
+    restoredRandom.fillInt(restoredFilled, 8, 0, 1000);
+    CHECK(random.next() == restoredRandom.next());
+    CHECK(std::memcmp(filled, restoredFilled, sizeof(filled)) == 0);
+  }
+
+  // a weapon saved to a file by one run fires its pattern when another run loads it
+  void testWeaponSurvivesFileRoundTrip()
+  {
+    EntityHandle armed;
+    {
+      // this table stands in for the run which saved the file, it is gone before the load
+      std::vector<BulletPattern> savedPatterns = {BulletPattern::single(50.0), BulletPattern::spread(3, 0.5, 80.0)};
+      World world;
+      armed = world.create(Position{toState(100), toState(100)}, Weapon{1, BulletEmitter(&savedPatterns[1], 1.0)});
+      BulletPool pool(16);
+      world.get<Weapon>(armed)->emitter.update(pool, 100.0, 100.0, 0.75);
+
+      Snapshot snapshot;
+      snapshot.save(world);
+      snapshot.saveToFile(SNAPSHOT_PATH);
+    }
+
+    std::vector<BulletPattern> patterns = {BulletPattern::single(50.0), BulletPattern::spread(3, 0.5, 80.0)};
+    Snapshot loaded;
+    loaded.loadFromFile(SNAPSHOT_PATH);
+    std::remove(SNAPSHOT_PATH);
+    World world;
+    loaded.restore(world);
+
+    CHECK_THROWS(resolveWeaponPatterns(world, patterns.data(), 1));
+    resolveWeaponPatterns(world, patterns.data(), patterns.size());
+
+    Weapon *weapon = world.get<Weapon>(armed);
+    CHECK(weapon != nullptr);
+    CHECK(weapon->patternId == 1);
+    CHECK(&weapon->emitter.getPattern() == &patterns[1]);
+
+    // 0.75 seconds were on the clock when it was saved, a quarter second more fires a volley
+    BulletPool pool(16);
+    CHECK(weapon->emitter.update(pool, 100.0, 100.0, 0.25) == 3);
+    CHECK(pool.getVelocityX(1) == fromState(patterns[1].getVelocitiesX()[1]));
+  }
+
+  // restoring an entity never moves the id counter backwards
+  void testEntityIdsStayUnique()
+  {
+    Entity saved;
+    Snapshot snapshot;
+    snapshot.save(saved);
+
+    Entity createdAfter;
+    snapshot.rewind();
+    snapshot.restore(saved);
+    Entity createdLater;
+
+    CHECK(!(createdLater == createdAfter));
+    CHECK(!(createdLater == saved));
+  }
+
+  // snapshots from another version, of another kind or cut short are refused
+  void testBadSnapshotsAreRejected()
+  {
+    Random random;
+    Snapshot snapshot;
+    snapshot.save(random);
+
+    std::vector<unsigned char> otherVersion = bytesOf(snapshot);
+    std::uint16_t version = Snapshot::VERSION + 1;
+    std::memcpy(otherVersion.data() + 4, &version, sizeof(version));
+    Snapshot loaded;
+    CHECK_THROWS(loaded.loadFromMemory(otherVersion.data(), otherVersion.size()));
+
+    std::vector<unsigned char> notASnapshot = bytesOf(snapshot);
+    notASnapshot[0] ^= 0xFF;
+    CHECK_THROWS(loaded.loadFromMemory(notASnapshot.data(), notASnapshot.size()));
+
+    std::vector<unsigned char> truncated = bytesOf(snapshot);
+    CHECK_THROWS(loaded.loadFromMemory(truncated.data(), truncated.size() - 1));
+
+    // sections must be restored in the order they were saved
+    snapshot.rewind();
+    BulletPool pool(4);
+    CHECK_THROWS(snapshot.restore(pool));
+
+    // a pool which is too small for the saved bullets
+    BulletPool big(8);
+    BulletPattern pattern = BulletPattern::ring(8, 10.0);
+    BulletEmitter emitter(&pattern, 0.0);
+    emitter.fire(big, 0.0, 0.0);
+    snapshot.beginSave();
+    snapshot.save(big);
+    snapshot.rewind();
+    CHECK_THROWS(snapshot.restore(pool));
+
+    CHECK_THROWS(loaded.loadFromFile("snapshot_test.missing"));
+  }
+}
+
+int main()
+{
+  testRoundTrip();
+  testWeaponSurvivesFileRoundTrip();
+  testEntityIdsStayUnique();
+  testBadSnapshotsAreRejected();
+  return finishTests("snapshot");
+}
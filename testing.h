@@ -0,0 +1,72 @@
+#ifndef TESTING_H
+#define TESTING_H
+
+#include <exception>
+#include <iostream>
+
+namespace gamelib
+{
+
+  /*
+
+  testing
+    - the behaviour of each module is checked by a NAME_test.cpp next to it, make test builds
+      every one of them into its own program and runs them all
+    - a test program calls its test functions from main and returns finishTests()
+    - CHECK and CHECK_THROWS print the failing expression and carry on, so one run shows
+      every broken check; the program exits non-zero when any check failed
+
+  */
+
+  namespace testing
+  {
+    inline int &failureCount()
+    {
+      static int failures = 0;
+      return failures;
+    }
+
+    inline int &checkCount()
+    {
+      static int checks = 0;
+      return checks;
+    }
+
+    inline void check(bool passed, const char *expression, const char *file, int line)
+    {
+      ++checkCount();
+      if (!passed)
+      {
+        ++failureCount();
+        std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+      }
+    }
+  }
+
+  // prints how many checks passed and returns the exit code for main
+  inline int finishTests(const char *name)
+  {
+    int failures = testing::failureCount();
+    std::cout << name << ": " << (testing::checkCount() - failures) << " of " << testing::checkCount() << " checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+  }
+}
+
+#define CHECK(expression) gamelib::testing::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+#define CHECK_THROWS(expression)                                              \
+  do                                                                          \
+  {                                                                           \
+    bool threw = false;                                                       \
+    try                                                                       \
+    {                                                                         \
+      expression;                                                             \
+    }                                                                         \
+    catch (const std::exception &)                                            \
+    {                                                                         \
+      threw = true;                                                           \
+    }                                                                         \
+    gamelib::testing::check(threw, "throws: " #expression, __FILE__, __LINE__); \
+  } while (false)
+
+#endif
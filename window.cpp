@@ -3,13 +3,15 @@
 // within this file we want to declare that we can see within the namespace of the class
 using namespace gamelib;
 
-Window::Window(const std::string &windowTitle, int windowWidth, int windowHeight)
+Window::Window(const std::string &windowTitle, int windowWidth, int windowHeight, bool headless)
 {
   std::seed_seq seed{
       std::random_device{}(),
       static_cast<unsigned int>(::time(nullptr)),
       static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count())};
-  rng.seed(seed);
+  std::uint32_t seedWords[2];
+  seed.generate(seedWords, seedWords + 2);
+  seedRandom((static_cast<std::uint64_t>(seedWords[0]) << 32u) | seedWords[1]);
 
   if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
   {
@@ -22,7 +24,7 @@ Window::Window(const std::string &windowTitle, int windowWidth, int windowHeight
           windowTitle.c_str(),
           SDL_WINDOWPOS_CENTERED,
           SDL_WINDOWPOS_CENTERED,
-          windowWidth, windowHeight, 0),
+          windowWidth, windowHeight, headless ? SDL_WINDOW_HIDDEN : 0),
       [](SDL_Window *windowPtr)
       { SDL_DestroyWindow(windowPtr); });
   if (!sdlWindow.get())
@@ -30,11 +32,13 @@ Window::Window(const std::string &windowTitle, int windowWidth, int windowHeight
     throw std::runtime_error("Unable to create SDL window:" + std::string(SDL_GetError()));
   }
 
+  // a headless window asks for the software renderer, which draws into memory, works without a
+  // display and reads back cheaply; the flag only applies to this renderer, unlike a hint
   sdlRenderer = std::shared_ptr<SDL_Renderer>(
       SDL_CreateRenderer(
           sdlWindow.get(),
           -1,
-          SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE),
+          (headless ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED) | SDL_RENDERER_TARGETTEXTURE),
       [](SDL_Renderer *rendererPtr)
       {
         SDL_DestroyRenderer(rendererPtr);
@@ -45,7 +49,8 @@ Window::Window(const std::string &windowTitle, int windowWidth, int windowHeight
   }
 
   running = true;
-  lastTime = static_cast<float>(SDL_GetTicks() * 0.001f);
+  lastCounter = SDL_GetPerformanceCounter();
+  setFrameMode(headless ? FrameMode::Uncapped : FrameMode::VSync);
 }
 
 bool Window::isOpen() const
@@ -121,9 +126,10 @@ bool Window::isKeyPressed(const std::string &keyId)
 
 float Window::resetClock()
 {
-  float currentTime = static_cast<float>(SDL_GetTicks() * 0.001f);
-  float deltaTime = currentTime - lastTime;
-  lastTime = currentTime;
+  // the millisecond tick count is too coarse for frame times, so use the performance counter
+  std::uint64_t currentCounter = SDL_GetPerformanceCounter();
+  float deltaTime = static_cast<float>(static_cast<double>(currentCounter - lastCounter) / static_cast<double>(SDL_GetPerformanceFrequency()));
+  lastCounter = currentCounter;
   return deltaTime;
 }
 
@@ -135,7 +141,10 @@ void Window::prepareRender()
 
 void Window::presentRender()
 {
+  // the frame has to be read back before it is presented
+  frameCapture.captureFrame(sdlRenderer.get());
   SDL_RenderPresent(sdlRenderer.get());
+  framePacer.endFrame();
 }
 
 const std::shared_ptr<SDL_Renderer> &Window::getRenderer() const
@@ -143,14 +152,67 @@ const std::shared_ptr<SDL_Renderer> &Window::getRenderer() const
   return sdlRenderer;
 }
 
+void Window::setFrameMode(FrameMode mode, double targetFps)
+{
+  framePacer.setTargetFps(targetFps);
+  if (mode == FrameMode::VSync)
+  {
+    // vsync runs at the refresh rate of the display, which is also what late frames are measured against
+    SDL_DisplayMode displayMode;
+    if (SDL_GetWindowDisplayMode(sdlWindow.get(), &displayMode) == 0 && displayMode.refresh_rate > 0)
+    {
+      framePacer.setTargetFps(displayMode.refresh_rate);
+    }
+    if (SDL_RenderSetVSync(sdlRenderer.get(), 1) != 0)
+    {
+      // this renderer cannot wait for the display, so the pacer has to
+      mode = FrameMode::TargetFps;
+    }
+  }
+  else
+  {
+    SDL_RenderSetVSync(sdlRenderer.get(), 0);
+  }
+  framePacer.setMode(mode);
+}
+
+FramePacer &Window::getFramePacer()
+{
+  return framePacer;
+}
+
+void Window::startCapture(const std::string &pathPrefix, CaptureFormat format, int everyNthFrame)
+{
+  frameCapture.start(sdlRenderer.get(), pathPrefix, format, everyNthFrame);
+}
+
+void Window::stopCapture()
+{
+  frameCapture.stop();
+}
+
+FrameCapture &Window::getFrameCapture()
+{
+  return frameCapture;
+}
+
+void Window::seedRandom(std::uint64_t seed)
+{
+  rng.seed(seed);
+  Random::seedThreads(seed);
+}
+
+Random &Window::getRandom()
+{
+  return rng;
+}
+
 int Window::getRandomInRangeInt(int lowInclusive, int highInclusive)
 {
-  std::uniform_int_distribution<int> dist(lowInclusive, highInclusive);
-  return dist(rng);
+  return rng.nextInt(lowInclusive, highInclusive);
 }
 
 double Window::getRandomInRangeDouble(double lowInclusive, double highInclusive)
 {
-  std::uniform_real_distribution<double> dist(lowInclusive, highInclusive);
-  return dist(rng);
+  return rng.nextDouble(lowInclusive, highInclusive);
 }
@@ -9,6 +9,10 @@
 #include <vector>
 #include <random>
 
+#include "random.h"
+#include "framepacer.h"
+#include "framecapture.h"
+
 namespace gamelib
 {
   class Window
@@ -18,16 +22,20 @@ namespace gamelib
     std::shared_ptr<SDL_Renderer> sdlRenderer;
     SDL_Event sdlEvent;
 
-    std::mt19937 rng;
+    Random rng;
+    FramePacer framePacer;
+    FrameCapture frameCapture;
     std::unordered_map<int, std::string> inverseKeymap;
     std::set<std::string> keysdown;
-    float lastTime;
+    std::uint64_t lastCounter;
     bool running;
     bool focused;
 
   public:
     std::unordered_map<std::string, int> keymap;
-    Window(const std::string &windowTitle, int windowWidth, int windowHeight);
+    // a headless window is hidden, uses the software renderer and runs uncapped; set
+    // SDL_VIDEODRIVER=dummy to run without a display
+    Window(const std::string &windowTitle, int windowWidth, int windowHeight, bool headless = false);
     bool isOpen() const;
     void close();
     void processEvents();
@@ -37,6 +45,18 @@ namespace gamelib
     void presentRender();
     const std::shared_ptr<SDL_Renderer> &getRenderer() const;
 
+    // paces presentRender(). targetFps is used by TargetFps mode; VSync falls back to
+    // TargetFps at the display refresh rate when the renderer cannot do vsync
+    void setFrameMode(FrameMode mode, double targetFps = 60.0);
+    FramePacer &getFramePacer();
+
+    // writes every everyNthFrame presented frame to pathPrefix_NNNNNN.ppm or .png from a background thread
+    void startCapture(const std::string &pathPrefix, CaptureFormat format, int everyNthFrame = 1);
+    void stopCapture();
+    FrameCapture &getFrameCapture();
+
+    void seedRandom(std::uint64_t seed);
+    Random &getRandom();
     int getRandomInRangeInt(int lowInclusive, int highInclusive);
     double getRandomInRangeDouble(double lowInclusive, double highInclusive);
   };